@@ -15,6 +15,11 @@ configure_file("${CMAKE_CURRENT_SOURCE_DIR}/cmake/version.rc.in" "${CMAKE_CURREN
 # Add generated files to the target
 target_sources("${PROJECT_NAME}" PRIVATE ${CMAKE_CURRENT_BINARY_DIR}/cmake/Plugin.h ${CMAKE_CURRENT_BINARY_DIR}/cmake/version.rc)
 
+# Timing zones are compiled out unless requested
+if(ENABLE_PROFILER)
+    target_compile_definitions("${PROJECT_NAME}" PRIVATE ENABLE_PROFILER)
+endif()
+
 # Precompile headers
 target_precompile_headers("${PROJECT_NAME}" PRIVATE include/PCH.h)
 
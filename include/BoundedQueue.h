@@ -0,0 +1,96 @@
+#pragma once
+
+// Bounded lock-free multi-producer multi-consumer queue (Vyukov). Every cell carries a sequence number
+// that tells producers and consumers whether it is free for their lap, so a push or pop is one CAS on
+// the shared position plus a copy. Capacity has to be a power of two, a full queue refuses the push
+// and leaves the decision to the caller.
+
+template <typename T, std::uint32_t Capacity>
+class BoundedQueue
+{
+	static_assert((Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+	static_assert(std::is_trivially_copyable_v<T>);
+
+public:
+	BoundedQueue() :
+		m_cells(std::make_unique<Cell[]>(Capacity))
+	{
+		for (std::uint32_t i = 0; i < Capacity; i++)
+		{
+			m_cells[i].sequence.store(i, std::memory_order_relaxed);
+		}
+	}
+
+	// false if full
+	bool tryPush(const T& value)
+	{
+		std::uint32_t pos = m_enqueuePos.load(std::memory_order_relaxed);
+
+		while (true)
+		{
+			Cell& cell = m_cells[pos & (Capacity - 1)];
+			const std::uint32_t sequence = cell.sequence.load(std::memory_order_acquire);
+			const auto diff = static_cast<std::int32_t>(sequence - pos);
+
+			if (diff == 0)
+			{
+				if (m_enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+				{
+					std::memcpy(&cell.value, &value, sizeof(T));
+					cell.sequence.store(pos + 1, std::memory_order_release);
+					return true;
+				}
+			}
+			else if (diff < 0)
+			{
+				return false;
+			}
+			else
+			{
+				pos = m_enqueuePos.load(std::memory_order_relaxed);
+			}
+		}
+	}
+
+	// false if empty
+	bool tryPop(T& value)
+	{
+		std::uint32_t pos = m_dequeuePos.load(std::memory_order_relaxed);
+
+		while (true)
+		{
+			Cell& cell = m_cells[pos & (Capacity - 1)];
+			const std::uint32_t sequence = cell.sequence.load(std::memory_order_acquire);
+			const auto diff = static_cast<std::int32_t>(sequence - (pos + 1));
+
+			if (diff == 0)
+			{
+				if (m_dequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+				{
+					std::memcpy(&value, &cell.value, sizeof(T));
+					cell.sequence.store(pos + Capacity, std::memory_order_release);
+					return true;
+				}
+			}
+			else if (diff < 0)
+			{
+				return false;
+			}
+			else
+			{
+				pos = m_dequeuePos.load(std::memory_order_relaxed);
+			}
+		}
+	}
+
+private:
+	struct Cell
+	{
+		std::atomic<std::uint32_t> sequence;
+		T value;
+	};
+
+	std::unique_ptr<Cell[]> m_cells;
+	alignas(64) std::atomic<std::uint32_t> m_enqueuePos{ 0 };
+	alignas(64) std::atomic<std::uint32_t> m_dequeuePos{ 0 };
+};
@@ -0,0 +1,94 @@
+#pragma once
+#include "Journal.h"
+#include "BoundedQueue.h"
+#include "EffectTable.h"
+
+// Toggle and uniform requests from the game, UI, Papyrus and overlay threads.
+// Producers only enqueue; the render thread drains everything in one batch per frame.
+
+class CommandQueue : public ISingleton<CommandQueue>
+{
+public:
+	enum class Type : std::uint8_t
+	{
+		ToggleEffect,
+		ToggleReShade,
+		SetUniform,
+		RestoreUniform, // back to the captured baseline, see UniformBaseline
+		PrewarmEffect // get a skipped effect compiled without rendering it, see EffectPrewarmer
+	};
+
+	struct Command
+	{
+		Type type = Type::ToggleEffect;
+		Journal::Source source = Journal::Source::Unknown;
+		Journal::ValueType valueType = Journal::ValueType::None;
+		std::uint8_t valueCount = 0;
+		bool state = false;
+		EffectTable::ID effect = EffectTable::s_invalidID;
+		std::uint64_t ruleID = 0;
+		std::uint32_t baseline = 0; // UniformBaseline handle, RestoreUniform only
+		char uniform[64] = {};
+		std::uint32_t values[4] = {}; // bit patterns, interpreted through valueType
+	};
+	static_assert(std::is_trivially_copyable_v<Command>);
+
+	void pushToggleEffect(EffectTable::ID effect, bool state, Journal::Source source, std::uint64_t ruleID);
+	void pushToggleReShade(bool state, Journal::Source source);
+
+	template <typename T>
+	void pushSetUniform(EffectTable::ID effect, const char* uniform, const T* values, size_t count, Journal::Source source, std::uint64_t ruleID);
+
+	void pushRestoreUniform(EffectTable::ID effect, const char* uniform, std::uint32_t baseline, std::uint64_t ruleID);
+
+	void pushPrewarmEffect(EffectTable::ID effect);
+
+	// consumer side, only called from the render thread. the ring goes first, the overflow holds
+	// the newest command per target that didn't fit, so it is always the later one
+	template <typename Func>
+	std::uint32_t drain(Func&& func)
+	{
+		std::uint32_t count = 0;
+		Command command;
+		while (m_queue.tryPop(command))
+		{
+			func(command);
+			count++;
+		}
+
+		if (m_overflowCount.load(std::memory_order_acquire) == 0)
+			return count;
+
+		std::vector<Command> overflow;
+		{
+			std::scoped_lock lock(m_overflowLock);
+			overflow.swap(m_overflow);
+			m_overflowCount.store(0, std::memory_order_release);
+		}
+
+		for (const auto& overflowed : overflow)
+		{
+			func(overflowed);
+			count++;
+		}
+		return count;
+	}
+
+	std::uint64_t getCoalescedCommands() const { return m_coalescedCommands.load(std::memory_order_relaxed); }
+
+private:
+	static constexpr std::uint32_t s_capacity = 4096; // power of two
+
+	void push(const Command& command);
+	void pushOverflow(const Command& command);
+
+	BoundedQueue<Command, s_capacity> m_queue;
+
+	// only touched once the ring is full (e.g. the game minimized and nothing presents)
+	std::mutex m_overflowLock;
+	std::vector<Command> m_overflow;
+	std::atomic<std::uint32_t> m_overflowCount{ 0 };
+	std::atomic_flag m_overflowWarned;
+
+	std::atomic<std::uint64_t> m_coalescedCommands{ 0 };
+};
@@ -0,0 +1,37 @@
+#pragma once
+
+// Runs the independent parts of a preset compile on a few threads. Every worker owns a deque of task
+// indices and takes from its back; one that runs dry steals from the front of another, so a key with
+// far more rules than the rest doesn't leave the other workers idle. Presets load rarely, the workers
+// only exist for the duration of run and the calling thread works along.
+
+class CompilePool : public ISingleton<CompilePool>
+{
+public:
+	using Task = std::function<void()>;
+
+	static constexpr std::uint32_t s_maxThreads = 8;
+
+	// blocks until every task ran, threads 0 uses the configured count
+	void run(std::vector<Task>& tasks, std::uint32_t threads = 0);
+
+	// 0 picks the hardware concurrency, capped to s_maxThreads
+	std::uint32_t getThreadCount() const;
+	void setThreadCount(std::uint32_t threads) { m_threads = std::min(threads, s_maxThreads); }
+	std::uint32_t getConfiguredThreadCount() const { return m_threads; }
+
+	std::uint64_t getStolenTasks() const { return m_stolenTasks.load(std::memory_order_relaxed); }
+
+private:
+	struct Worker
+	{
+		std::mutex lock;
+		std::deque<std::uint32_t> tasks;
+	};
+
+	// own deque first, then the others in turn
+	static bool take(std::vector<Worker>& workers, std::uint32_t self, std::uint32_t& task, bool& stolen);
+
+	std::uint32_t m_threads = 0;
+	std::atomic<std::uint64_t> m_stolenTasks{ 0 };
+};
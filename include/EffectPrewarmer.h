@@ -0,0 +1,43 @@
+#pragma once
+#include "EffectTable.h"
+
+// Effects that rules are about to enable get compiled ahead of time, so the stall ReShade's on-demand
+// loading causes lands at a moment we pick instead of the frame of the transition. The rule passes request
+// effects they expect soon; one request per interval is sent to the runtimes, every frame while the game
+// is paused. An effect is only requested once until the runtimes reload their effects.
+
+class EffectPrewarmer : public ISingleton<EffectPrewarmer>
+{
+public:
+	// any thread
+	void request(EffectTable::ID effect);
+
+	// game thread, once per frame
+	void update();
+
+	// render thread, the runtimes reloaded and may have skipped everything again
+	void reset();
+
+	bool isEnabled() const { return m_enabled.load(std::memory_order_relaxed); }
+	void setEnabled(const bool state) { m_enabled.store(state, std::memory_order_relaxed); }
+
+	int getLookaheadMinutes() const { return m_lookaheadMinutes.load(std::memory_order_relaxed); }
+	void setLookaheadMinutes(const int minutes) { m_lookaheadMinutes.store(std::clamp(minutes, 0, 24 * 60), std::memory_order_relaxed); }
+
+	std::chrono::milliseconds getInterval() const { return std::chrono::milliseconds(m_intervalMs.load(std::memory_order_relaxed)); }
+	void setInterval(const std::chrono::milliseconds interval) { m_intervalMs.store(std::max<long long>(interval.count(), 0), std::memory_order_relaxed); }
+
+	size_t getPendingCount() const;
+	size_t getSentCount() const { return m_sentCount.load(std::memory_order_relaxed); }
+
+private:
+	mutable std::mutex m_lock;
+	std::bitset<EffectTable::s_capacity> m_requested;
+	std::deque<EffectTable::ID> m_pending;
+	std::chrono::steady_clock::time_point m_nextSend{};
+
+	std::atomic<bool> m_enabled{ true };
+	std::atomic<int> m_lookaheadMinutes{ 60 };
+	std::atomic<long long> m_intervalMs{ 1000 };
+	std::atomic<size_t> m_sentCount{ 0 };
+};
@@ -0,0 +1,36 @@
+#pragma once
+#include "Utils.h"
+
+// Interns effect names into dense IDs, so rules, caches and commands carry a uint16_t
+// and per-effect state can live in flat arrays indexed by ID.
+// IDs are never reused; names are readable without locking once published.
+
+class EffectTable : public ISingleton<EffectTable>
+{
+public:
+	using ID = std::uint16_t;
+
+	static constexpr ID s_entireReShade = 0;
+	static constexpr ID s_invalidID = std::numeric_limits<ID>::max();
+	static constexpr size_t s_capacity = 4096;
+
+	EffectTable() { intern("EntireReShade"); }
+
+	// returns the existing ID or assigns the next one, s_invalidID once the table is full
+	ID intern(std::string_view name);
+
+	// s_invalidID if the name was never interned
+	ID find(std::string_view name) const;
+
+	const char* getName(ID id) const;
+
+	size_t size() const { return m_count.load(std::memory_order_acquire); }
+
+private:
+	mutable std::shared_mutex m_lock; // only guards the lookup map and writers
+	std::unordered_map<std::string, ID, Utils::StringHash, std::equal_to<>> m_ids;
+
+	// fixed storage so a published name never moves
+	std::array<std::string, s_capacity> m_names;
+	std::atomic<size_t> m_count{ 0 };
+};
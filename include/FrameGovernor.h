@@ -0,0 +1,40 @@
+#pragma once
+#include "EffectTable.h"
+#include "CommandQueue.h"
+#include "GovernorPolicy.h"
+
+static_assert(std::is_same_v<GovernorPolicy::EffectID, EffectTable::ID>);
+static_assert(GovernorPolicy::s_invalidID == EffectTable::s_invalidID && GovernorPolicy::s_capacity == EffectTable::s_capacity);
+
+// Keeps the frame time under a budget by shedding effects. Frame times measured at reshade_present of
+// the primary runtime are fed to a GovernorPolicy, and its shed and restore decisions go through the
+// command queue like any other toggle.
+
+class FrameGovernor : public ISingleton<FrameGovernor>
+{
+public:
+	using Config = GovernorPolicy::Config;
+	using Candidate = GovernorPolicy::Candidate;
+	using Action = GovernorPolicy::Action;
+
+	// restores everything that is currently shed
+	void configure(const Config& config, std::vector<Candidate> candidates);
+
+	// render thread, measures the time since the last present of the primary runtime and applies the decision
+	void onPresent();
+
+	// render thread, toggles from other sources while an effect is shed only change what it is restored to
+	void observe(const CommandQueue::Command& command);
+	bool isShed(EffectTable::ID effect) const;
+
+	float getPercentileMs() const { return m_percentileMs.load(std::memory_order_relaxed); }
+	Config getConfig() const;
+	std::vector<Candidate> getCandidates() const;
+
+private:
+	mutable std::mutex m_lock; // configure runs on the game thread, everything else on the render thread
+	GovernorPolicy m_policy;
+
+	std::atomic<float> m_percentileMs{ 0.f };
+	std::chrono::steady_clock::time_point m_lastPresent{};
+};
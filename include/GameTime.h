@@ -0,0 +1,72 @@
+#pragma once
+
+// In-game time of day as integer minutes (0-1439) instead of the old hours + minutes / 100 floats.
+// Time rules compile their windows into a bit per minute, so checking one is a single load and shift.
+// Date conditions compile the same way into one word per rule and are only checked when the day rolls over.
+
+namespace GameTime
+{
+	inline constexpr std::uint16_t kMinutesPerDay = 24 * 60;
+
+	// both ends are included, start > stop wraps past midnight (22:00 - 04:00)
+	struct Window
+	{
+		std::uint16_t start = 0;
+		std::uint16_t stop = 0;
+	};
+
+	using MinuteMask = std::array<std::uint64_t, (kMinutesPerDay + 63) / 64>;
+
+	constexpr std::uint16_t toMinuteOfDay(int hours, int minutes)
+	{
+		return static_cast<std::uint16_t>(std::clamp(hours, 0, 23) * 60 + std::clamp(minutes, 0, 59));
+	}
+
+	// presets written before windows existed stored HH.MM as a float
+	std::uint16_t fromLegacyTime(float time);
+
+	MinuteMask buildMask(const std::vector<Window>& windows);
+
+	inline bool contains(const MinuteMask& mask, std::uint16_t minute)
+	{
+		return (mask[minute >> 6] >> (minute & 63)) & 1;
+	}
+
+	// first minute after the given one with its bit set, wraps past midnight, kMinutesPerDay for an empty mask
+	std::uint16_t findNext(const MinuteMask& mask, std::uint16_t minute);
+
+	// requires the calendar
+	std::uint16_t getCurrentMinute();
+
+	// requires the calendar, in-game minutes (with fraction) until the clock reaches the minute again
+	float getMinutesUntil(std::uint16_t minute);
+
+	enum DateBit : std::uint8_t
+	{
+		kWeekday = 0, // one bit per day of the week, Sundas first
+		kMonth = 8 // one bit per month, Morning Star first
+	};
+
+	inline constexpr std::uint32_t kWeekdayBits = 0x7Fu << kWeekday;
+	inline constexpr std::uint32_t kMonthBits = 0xFFFu << kMonth;
+
+	// names used in the preset and the UI, in calendar order
+	inline const std::vector<std::string> s_dayOptions = { "Sundas", "Morndas", "Tirdas", "Middas", "Turdas", "Fredas", "Loredas" };
+	inline const std::vector<std::string> s_monthOptions = { "Morning Star", "Sun's Dawn", "First Seed", "Rain's Hand", "Second Seed", "Midyear",
+		"Sun's Height", "Last Seed", "Hearthfire", "Frostfall", "Sun's Dusk", "Evening Star" };
+	inline const std::vector<std::string> s_seasonOptions = { "Spring", "Summer", "Autumn", "Winter" };
+
+	// any of within each group, an empty group matches every day, seasons add their months
+	std::uint32_t buildDateMask(const std::vector<std::string>& days, const std::vector<std::string>& months, const std::vector<std::string>& seasons);
+
+	inline bool matchesDate(std::uint32_t dateMask, std::uint32_t date)
+	{
+		return (dateMask & date & kWeekdayBits) && (dateMask & date & kMonthBits);
+	}
+
+	// requires the calendar, exactly one weekday and one month bit
+	std::uint32_t getCurrentDate();
+
+	// requires the calendar, changes exactly when the in-game day rolls over
+	std::uint32_t getCurrentDay();
+}
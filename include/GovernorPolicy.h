@@ -0,0 +1,92 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <bitset>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <vector>
+
+// The shed/restore decisions of the frame governor. Frame times go into a rolling window; once its
+// percentile passes the target, the lowest priority effect that still renders is switched off, one at a
+// time with a settle period in between so every decision sees the result of the previous one. The frame
+// time a shed saved is kept as the effect's measured cost, and the last shed effect comes back once the
+// percentile plus that cost fits under the target scaled by the restore ratio.
+// Nothing here touches the game or ReShade and nothing is locked, so tests/ replays synthetic frame time
+// traces against it on any platform; FrameGovernor owns the instance used in game.
+
+class GovernorPolicy
+{
+public:
+	using EffectID = std::uint16_t; // EffectTable::ID
+	static constexpr EffectID s_invalidID = std::numeric_limits<EffectID>::max();
+	static constexpr size_t s_capacity = 4096; // EffectTable::s_capacity
+
+	static constexpr std::uint32_t s_windowSize = 120;
+	static constexpr std::uint32_t s_evaluateInterval = 10; // frames between two looks at the percentile
+	static constexpr float s_maxFrameMs = 250.f; // loading screens and hitches say nothing about the preset
+
+	struct Config
+	{
+		bool enabled = false;
+		float targetMs = 16.7f;
+		float percentile = 0.95f;
+		float restoreRatio = 0.85f; // hysteresis, a restore has to leave this much of the budget
+		std::uint32_t settleFrames = s_windowSize; // a full window after every shed or restore
+	};
+
+	struct Candidate
+	{
+		EffectID effect = s_invalidID;
+		int priority = 0; // lower is shed first
+		bool shed = false;
+		bool wanted = true; // what the other toggle sources asked for while it was shed
+		float measuredCostMs = 0.f;
+	};
+
+	enum class Action : std::uint8_t
+	{
+		None,
+		Shed,
+		Restore
+	};
+
+	struct Decision
+	{
+		Action action = Action::None;
+		EffectID effect = s_invalidID;
+		bool state = false;
+	};
+
+	// returns the candidates that were shed, the caller puts them back to what they want
+	std::vector<Candidate> configure(const Config& config, std::vector<Candidate> candidates);
+
+	// feeds one frame, isEnabled tells whether an effect currently renders
+	Decision onFrame(float frameMs, const std::function<bool(EffectID)>& isEnabled);
+
+	// a toggle from another source, only changes what a shed effect is restored to
+	void observe(EffectID effect, bool state);
+	bool isShed(EffectID effect) const { return effect < s_capacity && m_shed.test(effect); }
+
+	float getPercentileMs() const { return m_percentileMs; }
+	const Config& getConfig() const { return m_config; }
+	const std::vector<Candidate>& getCandidates() const { return m_candidates; }
+
+private:
+	float computePercentile() const;
+
+	Config m_config;
+	std::vector<Candidate> m_candidates; // sorted by priority
+	std::vector<size_t> m_shedOrder; // indices into m_candidates, restored last in first out
+	std::bitset<s_capacity> m_shed;
+
+	std::array<float, s_windowSize> m_frameTimes{};
+	std::uint32_t m_nextFrame = 0;
+	std::uint32_t m_frameCount = 0;
+	std::uint32_t m_framesSinceAction = 0;
+	float m_percentileMs = 0.f;
+
+	// the shed whose saving is measured once the window settled
+	size_t m_measuring = SIZE_MAX;
+	float m_percentileBeforeShed = 0.f;
+};
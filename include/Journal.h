@@ -0,0 +1,104 @@
+#pragma once
+#include "BoundedQueue.h"
+
+// Records every technique state and uniform write into a fixed-size lock-free ring buffer.
+// A background thread drains it into a compact binary log that can be decoded into CSV.
+
+class Journal : public ISingleton<Journal>
+{
+public:
+	enum class Source : std::uint8_t
+	{
+		Unknown,
+		Menu,
+		Weather,
+		Time,
+		Interior,
+		Papyrus,
+		UI,
+		Rule,
+		Restore,
+		Governor
+	};
+
+	enum class Kind : std::uint8_t
+	{
+		Technique,
+		Uniform,
+		EffectsState
+	};
+
+	enum class ValueType : std::uint8_t
+	{
+		None,
+		Bool,
+		Int,
+		UInt,
+		Float
+	};
+
+	struct Record
+	{
+		std::uint64_t timestamp = 0; // microseconds since epoch
+		std::uint64_t ruleID = 0;
+		Kind kind = Kind::Technique;
+		Source source = Source::Unknown;
+		ValueType valueType = ValueType::None;
+		std::uint8_t valueCount = 0;
+		std::uint8_t oldState = 0;
+		std::uint8_t newState = 0;
+		bool oldKnown = true; // uniforms nothing wrote or read since the last reload have no old value
+		char effect[48] = {};
+		char uniform[32] = {};
+		std::uint32_t oldValues[4] = {};
+		std::uint32_t newValues[4] = {};
+	};
+	static_assert(std::is_trivially_copyable_v<Record>);
+
+	void start();
+	void stop();
+
+	bool isEnabled() const { return m_enabled.load(std::memory_order_relaxed); }
+	void setEnabled(const bool enabled) { m_enabled.store(enabled, std::memory_order_relaxed); }
+
+	void recordTechnique(Source source, std::uint64_t ruleID, const char* effect, bool oldState, bool newState);
+	void recordEffectsState(Source source, bool oldState, bool newState);
+
+	// oldValues may be null when the previous value isn't known
+	template <typename T>
+	void recordUniform(Source source, std::uint64_t ruleID, const char* effect, const char* uniform, const T* oldValues, const T* newValues, size_t count);
+
+	std::uint64_t getWrittenRecords() const { return m_writtenRecords.load(std::memory_order_relaxed); }
+	std::uint64_t getDroppedRecords() const { return m_droppedRecords.load(std::memory_order_relaxed); }
+
+	std::filesystem::path getLogPath() const;
+
+	static bool decodeToCSV(const std::filesystem::path& logPath, const std::filesystem::path& csvPath);
+
+	static const char* getSourceName(Source source);
+
+private:
+	static constexpr std::uint32_t s_capacity = 8192; // power of two
+	static constexpr std::uint32_t s_magic = 0x4A544552; // "RETJ"
+	static constexpr std::uint32_t s_version = 2;
+
+	// drained by a single writer thread, allocated on the first start
+	using Queue = BoundedQueue<Record, s_capacity>;
+
+	void push(const Record& record);
+
+	void writerLoop(std::stop_token stopToken);
+
+	std::unique_ptr<Queue> m_queue;
+
+	std::atomic<bool> m_enabled{ false };
+	std::atomic<std::uint64_t> m_writtenRecords{ 0 };
+	bool m_fileStarted = false; // the first start of a session truncates, later ones append
+
+	// lets stop interrupt the writer's wait instead of joining through a full interval
+	std::mutex m_wakeLock;
+	std::condition_variable_any m_wake;
+	std::atomic<std::uint64_t> m_droppedRecords{ 0 };
+
+	std::jthread m_writer;
+};
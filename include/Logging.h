@@ -0,0 +1,8 @@
+#pragma once
+
+namespace Logging
+{
+	// Sets up the default spdlog logger from the [Logging] section of the INI.
+	// In async mode log calls only enqueue; a background thread formats, writes and flushes.
+	void Init();
+}
@@ -1,5 +1,18 @@
 #pragma once
 #include <glaze/json/json_t.hpp>
+#include "Journal.h"
+#include "EffectTable.h"
+#include "CommandQueue.h"
+#include "RuntimeRegistry.h"
+#include "ToggleSource.h"
+#include "Rules.h"
+#include "GameTime.h"
+#include "UniformAnimator.h"
+#include "UniformTransitions.h"
+#include "UniformBindings.h"
+#include "TickScheduler.h"
+#include "ToggleDebouncer.h"
+#include "PassFingerprint.h"
 
 struct UniformInfo
 {
@@ -16,6 +29,14 @@ struct UniformInfo
 	int tempIntValues[4] = { 0 };
 	unsigned int tempUIntValues[4] = { 0 };
 
+	// float uniforms only, overrides floatValues while the rule applies it
+	std::vector<Keyframe> keyframes;
+	std::string interpolation = "Linear";
+	std::shared_ptr<const UniformAnimator::Curve> curve; // sampled from keyframes on load, not serialized
+
+	// float uniforms only, overrides keyframes and floatValues while the rule applies it
+	UniformBinding binding;
+
 	void setBoolValues(const std::uint8_t& value)
 	{
 		boolValue = value;
@@ -56,8 +77,11 @@ struct MenuToggleInformation
 	std::string menuName{};
 	bool state = true;
 	bool isToggled = false;
+	ToggleTiming timing{};
 
 	std::vector<UniformInfo> uniforms;
+	EffectTable::ID effectID = EffectTable::s_invalidID; // assigned on load, not serialized
+	uint64_t id = 0; // assigned on load, not serialized
 };
 
 struct WeatherToggleInformation
@@ -67,8 +91,10 @@ struct WeatherToggleInformation
 	bool state = true;
 	bool isToggled = false;
 	uint64_t id = 0;
+	ToggleTiming timing{};
 
 	std::vector<UniformInfo> uniforms;
+	EffectTable::ID effectID = EffectTable::s_invalidID; // assigned on load, not serialized
 };
 
 struct InteriorToggleInformation
@@ -76,37 +102,64 @@ struct InteriorToggleInformation
 	std::string effectName{};
 	bool state = true;
 	uint64_t id = 0;
+	ToggleTiming timing{};
 
 	std::vector<UniformInfo> uniforms;
+	EffectTable::ID effectID = EffectTable::s_invalidID; // assigned on load, not serialized
 };
 
 struct TimeToggleInformation
 {
 	std::string effectName{};
-	float startTime = 0.f;
-	float stopTime = 0.f;
+	std::vector<GameTime::Window> windows{}; // any of
 	bool state = true;
 	bool isToggled = false;
 	uint64_t id = 0;
+	ToggleTiming timing{};
+
+	// any of, empty means every day
+	std::vector<std::string> days{};
+	std::vector<std::string> months{};
+	std::vector<std::string> seasons{};
 
 	std::vector<UniformInfo> uniforms;
 
+	// old HH.MM format, only read to migrate presets without windows
+	float startTime = 0.f;
+	float stopTime = 0.f;
+
+	EffectTable::ID effectID = EffectTable::s_invalidID; // assigned on load, not serialized
+	GameTime::MinuteMask minuteMask{}; // built from windows on load, not serialized
+	std::uint32_t dateMask = GameTime::kWeekdayBits | GameTime::kMonthBits; // built on load, not serialized
+	bool activeToday = true; // dateMask against the current date, refreshed on day rollover
 };
 
-class IDGenerator
+// several conditions that all have to hold, see Rules.h
+struct RuleToggleInformation
 {
-public:
-	static uint64_t getNextID()
-	{
-		static uint64_t currentID = 0;
-		return ++currentID;
-	}
+	std::string effectName{};
+	bool state = true;
+	int startHour = 0; // start == stop means the whole day
+	int stopHour = 0;
+	std::string location = "Any";
+	std::string menu = "Any";
+	std::vector<std::string> weathers{}; // any of, empty means every weather
+	bool isToggled = false;
+	uint64_t id = 0;
+	ToggleTiming timing{};
+
+	std::vector<UniformInfo> uniforms;
+	EffectTable::ID effectID = EffectTable::s_invalidID; // assigned on load, not serialized
 };
 
 class Manager : public ISingleton<Manager>
 {
 	// class for main functions used for all features
 
+	// the weather, time and interior passes, see ToggleSource.h
+	template <typename Policy>
+	friend class ToggleSource;
+
 public:
 
 	bool parseJSONPreset(const std::string& presetName);
@@ -133,31 +186,74 @@ public:
 
 	void toggleEffectInterior(const bool isInterior);
 
-	void toggleEffect(const char* technique, bool state) const;
+	void toggleEffectRules();
 
-	void toggleReshade(const bool state) const;
+	// game thread, requests the compile of effects the time, weather and interior rules are about to enable
+	void prewarmUpcomingEffects();
 
-	template <typename T>
-	void removeById(std::vector<T>& vec, const T& objToRemove);
+	// game thread, how long the result of each pass can't change, see TickScheduler
+	TickScheduler::Clock::duration getNextWeatherChange() const;
+	TickScheduler::Clock::duration getNextTimeChange() const;
+	TickScheduler::Clock::duration getNextRulesChange() const;
+
+	// both only enqueue, the change is applied by executeCommands on the next frame
+	void toggleEffect(const char* technique, bool state, Journal::Source source, std::uint64_t ruleID = 0) const;
+	void toggleEffect(EffectTable::ID effect, bool state, Journal::Source source, std::uint64_t ruleID = 0, const ToggleTiming& timing = {}) const;
+
+	void toggleReshade(const bool state, Journal::Source source) const;
+
+	// render thread, drains the command queue and applies the batch to every live runtime
+	void executeCommands();
+
+	// game thread, evaluates a freshly loaded preset once without waiting for the next update interval
+	void evaluatePresetSwitch();
+
+	struct PresetSwitchStats
+	{
+		std::uint32_t writes = 0;
+		std::uint32_t skipped = 0; // already in the target state
+		std::uint32_t dropped = 0; // replaced by a later command of the same switch
+	};
+	PresetSwitchStats getPresetSwitchStats() const { return m_presetSwitchStats; }
+
+	std::uint64_t getCoalescedToggles() const { return m_coalescedToggles; }
+
+	struct CompileBenchmarkResult
+	{
+		size_t ruleCount = 0;
+		std::uint32_t threads = 0;
+		double ms = 0.0;
+		double speedup = 0.0; // against one thread
+	};
+
+	// a synthetic preset of ruleCount rules spread over every source, compiled with 1, 2, 4 and 8 threads
+	static std::vector<CompileBenchmarkResult> runCompileBenchmark(size_t ruleCount = 50000);
 
-	void removeTimeById(const TimeToggleInformation& info) { removeById(m_timeToggleCache.second, info); }
-	void removeInteriorById(const InteriorToggleInformation& info) { removeById(m_interiorToggleCache.second, info); }
-	void removeWeatherById(const WeatherToggleInformation& info) { removeById(m_weatherToggleCache.second, info); }
+	const PassFingerprint& getFingerprint(TickScheduler::Pass pass) const { return m_fingerprints[static_cast<std::size_t>(pass)]; }
+	void invalidateFingerprints() { std::scoped_lock lock(m_dataLock); for (auto& fingerprint : m_fingerprints) { fingerprint.invalidate(); } }
 
-	template <typename T, typename V>
-	void updateOrAddObject(V& container, const T& objToUpdate);
+	// drops a deleted rule from its cache without reverting it
+	void removeTimeById(const TimeToggleInformation& info) { std::scoped_lock lock(m_dataLock); m_timeToggleCache.release(info.id); }
+	void removeInteriorById(const InteriorToggleInformation& info) { std::scoped_lock lock(m_dataLock); m_interiorToggleCache.release(info.id); }
+	void removeWeatherById(const WeatherToggleInformation& info) { std::scoped_lock lock(m_dataLock); m_weatherToggleCache.release(info.id); }
 
-	std::map<std::string, std::vector<MenuToggleInformation>> getMenuToggleInfo() const { return m_menuToggleInfo; }
-	void setMenuToggleInfo(const std::map<std::string, std::vector<MenuToggleInformation>>& info) { m_menuToggleInfo = info; }
+	std::map<std::string, std::vector<MenuToggleInformation>> getMenuToggleInfo() const { std::scoped_lock lock(m_dataLock); return m_menuToggleInfo; }
+	void setMenuToggleInfo(const std::map<std::string, std::vector<MenuToggleInformation>>& info) { std::scoped_lock lock(m_dataLock); replaceRules(m_menuToggleInfo, info); internEffects(m_menuToggleInfo); compileCurves(m_menuToggleInfo); assignRuleIDs(m_menuToggleInfo); }
 
-	std::map<std::string, std::vector<TimeToggleInformation>> getTimeToggleInfo() const { return m_timeToggleInfo; }
-	void setTimeToggleInfo(const std::map<std::string, std::vector<TimeToggleInformation>>& info) { m_timeToggleInfo = info; }
+	std::map<std::string, std::vector<TimeToggleInformation>> getTimeToggleInfo() const { std::scoped_lock lock(m_dataLock); return m_timeToggleInfo; }
+	void setTimeToggleInfo(const std::map<std::string, std::vector<TimeToggleInformation>>& info) { std::scoped_lock lock(m_dataLock); replaceRules(m_timeToggleInfo, info); internEffects(m_timeToggleInfo); compileCurves(m_timeToggleInfo); assignRuleIDs(m_timeToggleInfo); compileTimeRules(m_timeToggleInfo); TickScheduler::GetSingleton()->wake(TickScheduler::Pass::Time); }
 
-	std::map<std::string, std::vector<WeatherToggleInformation>> getWeatherToggleInfo() const { return m_weatherToggleInfo; }
-	void setWeatherToggleInfo(const std::map<std::string, std::vector<WeatherToggleInformation>>& info) { m_weatherToggleInfo = info; }
+	std::map<std::string, std::vector<WeatherToggleInformation>> getWeatherToggleInfo() const { std::scoped_lock lock(m_dataLock); return m_weatherToggleInfo; }
+	void setWeatherToggleInfo(const std::map<std::string, std::vector<WeatherToggleInformation>>& info) { std::scoped_lock lock(m_dataLock); replaceRules(m_weatherToggleInfo, info); internEffects(m_weatherToggleInfo); compileCurves(m_weatherToggleInfo); assignRuleIDs(m_weatherToggleInfo); m_fingerprints[static_cast<std::size_t>(TickScheduler::Pass::Weather)].invalidate(); TickScheduler::GetSingleton()->wake(TickScheduler::Pass::Weather); }
 
-	std::map<std::string, std::vector<InteriorToggleInformation>> getInteriorToggleInfo() const { return m_interiorToggleInfo; }
-	void setInteriorToggleInfo(const std::map<std::string, std::vector<InteriorToggleInformation>>& info) { m_interiorToggleInfo = info; }
+	std::map<std::string, std::vector<InteriorToggleInformation>> getInteriorToggleInfo() const { std::scoped_lock lock(m_dataLock); return m_interiorToggleInfo; }
+	void setInteriorToggleInfo(const std::map<std::string, std::vector<InteriorToggleInformation>>& info) { std::scoped_lock lock(m_dataLock); replaceRules(m_interiorToggleInfo, info); internEffects(m_interiorToggleInfo); compileCurves(m_interiorToggleInfo); assignRuleIDs(m_interiorToggleInfo); }
+
+	std::vector<RuleToggleInformation> getRuleToggleInfo() const { std::scoped_lock lock(m_dataLock); return m_ruleToggleInfo; }
+	void setRuleToggleInfo(const std::vector<RuleToggleInformation>& info) { std::scoped_lock lock(m_dataLock); replaceRules(m_ruleToggleInfo, info); internEffects(m_ruleToggleInfo); compileCurves(m_ruleToggleInfo); assignRuleIDs(m_ruleToggleInfo); m_rulesDirty = true; TickScheduler::GetSingleton()->wake(TickScheduler::Pass::Rules); }
+
+	bool isJournalEnabled() const { return m_journalEnabled; }
+	void setJournalEnabled(const bool state) { m_journalEnabled = state; }
 
 	std::string getLastPreset() const { return m_lastPresetName; }
 	void setLastPreset(const std::string& updatedPreset) { m_lastPresetName = updatedPreset; }
@@ -167,42 +263,275 @@ public:
 	bool isReShadeInstalled() const { return m_isReshadeInstalled; }
 	void setReShadeInstalled(const bool state) { m_isReshadeInstalled = state; }
 
+	// runtime defaults to the primary one, which is then held through the registry for the call
 	template<typename T>
-	void setUniformValue(const reshade::api::effect_uniform_variable& uniformVariable, T* value, size_t count);
+	void setUniformValue(const reshade::api::effect_uniform_variable& uniformVariable, T* value, size_t count, reshade::api::effect_runtime* runtime = nullptr);
 
 	template<typename T>
-	void getUniformValue(const reshade::api::effect_uniform_variable& uniformVariable, T* value, size_t count);
+	void getUniformValue(const reshade::api::effect_uniform_variable& uniformVariable, T* value, size_t count, reshade::api::effect_runtime* runtime = nullptr);
+
+	void getUniformBits(const reshade::api::effect_uniform_variable& uniformVariable, Journal::ValueType valueType, std::uint32_t* bits, size_t count, reshade::api::effect_runtime* runtime);
+
+	int getUniformDimension(const reshade::api::effect_uniform_variable& uniformVariable, reshade::api::effect_runtime* runtime = nullptr) const;
+	reshade::api::format getUniformType(const reshade::api::effect_uniform_variable& uniformVariable) const;
 
-	int getUniformDimension(const reshade::api::effect_uniform_variable& uniformVariable) const;
+	bool effectExists(const char* effect) const;
 
-	bool effectExists(const char* effect);
+	// render thread, called whenever a runtime is added, removed or (re)loaded its effects
+	void rebuildEffectIndex();
 
 private:
 
-	void setUniformValues(UniformInfo& uniform);
+	void setUniformValues(EffectTable::ID effect, UniformInfo& uniform, Journal::Source source, std::uint64_t ruleID);
 
-	bool timeWithinRange(const float& startTime, const float& stopTime) const;
+	// writes the uniforms of an activated rule, they are restored once no active rule holds them anymore
+	void applyRuleUniforms(EffectTable::ID effect, std::vector<UniformInfo>& uniforms, Journal::Source source, std::uint64_t ruleID);
+	static void releaseRuleUniforms(std::uint64_t ruleID) { UniformBaseline::GetSingleton()->release(ruleID); }
 
-	bool allowtoggleEffectWeather(const WeatherToggleInformation& cachedweather, const std::map<std::string, std::vector<WeatherToggleInformation>>::iterator& it) const;
+	template <typename T>
+	static void internEffects(std::vector<T>& infos)
+	{
+		const auto table = EffectTable::GetSingleton();
+		for (auto& info : infos)
+		{
+			info.effectID = table->intern(info.effectName);
+		}
+	}
 
-	bool allowtoggleEffectTime(const TimeToggleInformation& cachedweather, const std::map<std::string, std::vector<TimeToggleInformation>>::iterator& it) const;
+	template <typename T>
+	static void internEffects(std::map<std::string, std::vector<T>>& map)
+	{
+		for (auto& [key, infos] : map)
+		{
+			internEffects(infos);
+		}
+	}
 
-	bool allowtoggleEffectInterior(const InteriorToggleInformation& cachedinterior, const std::map<std::string, std::vector<InteriorToggleInformation>>::iterator& it) const;
+	// the part of a load that only touches the rules themselves, chunks can compile on different threads
+	template <typename T>
+	static void compileChunk(std::span<T> infos)
+	{
+		const auto table = EffectTable::GetSingleton();
+		for (auto& info : infos)
+		{
+			info.effectID = table->intern(info.effectName);
+			compileCurves(info.uniforms);
+		}
+	}
+
+	// every source of a preset, the members on a load, synthetic ones for the benchmark
+	struct CompileSources
+	{
+		std::map<std::string, std::vector<MenuToggleInformation>>& menu;
+		std::map<std::string, std::vector<TimeToggleInformation>>& time;
+		std::map<std::string, std::vector<WeatherToggleInformation>>& weather;
+		std::map<std::string, std::vector<InteriorToggleInformation>>& interior;
+		std::vector<RuleToggleInformation>& rules;
+	};
+
+	// at most this many rules of one key per CompilePool task
+	static constexpr size_t s_compileChunk = 512;
+
+	// interns effects, samples curves and builds the time masks and the compound rule store on the CompilePool,
+	// rule IDs are left to the caller
+	static void compilePreset(const CompileSources& sources, GameTime::MinuteMask& timeBoundaries, Rules::RuleStore& ruleStore, std::uint32_t threads = 0);
+
+	// rules loaded from a preset are numbered densely, rules added afterwards continue the sequence,
+	// so an ID never changes while the rule exists and can index the toggle caches
+	template <typename T>
+	void assignRuleIDs(std::vector<T>& infos, const bool renumber = false)
+	{
+		for (auto& info : infos)
+		{
+			if (renumber || info.id == 0)
+			{
+				info.id = ++m_lastRuleID;
+			}
+		}
+	}
+
+	template <typename T>
+	void assignRuleIDs(std::map<std::string, std::vector<T>>& map, const bool renumber = false)
+	{
+		for (auto& [key, infos] : map)
+		{
+			assignRuleIDs(infos, renumber);
+		}
+	}
+
+	static TickScheduler::Clock::duration toRealTime(float gameMinutes);
+
+	// migrates legacy start/stop times, rebuilds the minute and date masks and adds where the rule flips to boundaries
+	static void compileTimeRule(TimeToggleInformation& info, GameTime::MinuteMask& boundaries);
+
+	// migrates legacy start/stop times and rebuilds the minute and date masks
+	void compileTimeRules(std::map<std::string, std::vector<TimeToggleInformation>>& map);
+
+	// reverts everything the current preset toggled, IDs are about to be reassigned
+	void releaseToggleCaches();
+
+	// samples keyframe tracks that don't have a lookup table yet
+	static void compileCurves(std::vector<UniformInfo>& uniforms)
+	{
+		for (auto& uniform : uniforms)
+		{
+			if (!uniform.curve && !uniform.keyframes.empty())
+			{
+				uniform.curve = UniformAnimator::buildCurve(uniform.keyframes, UniformAnimator::getInterpolation(uniform.interpolation));
+			}
+		}
+	}
+
+	template <typename T>
+	static void compileCurves(std::vector<T>& infos)
+	{
+		for (auto& info : infos)
+		{
+			compileCurves(info.uniforms);
+		}
+	}
+
+	template <typename T>
+	static void compileCurves(std::map<std::string, std::vector<T>>& map)
+	{
+		for (auto& [key, infos] : map)
+		{
+			compileCurves(infos);
+		}
+	}
+
+	// write is false for commands that wouldn't change anything, only the baselines are updated then
+	void applyCommand(RuntimeRegistry::Entry& entry, const CommandQueue::Command& command, bool record, bool write = true);
+
+	// only writes what differs from the runtime's current state, see StateSnapshot
+	void applyPresetSwitch();
+
+	// the last toggle of each technique within one frame wins, so rule sources firing together rebuild the effect chain once
+	void coalesceToggles();
+
+	// what the passes write into a rule while it is live
+	struct RuntimeState
+	{
+		bool isToggled = false;
+		bool activeToday = true;
+	};
+
+	template <typename T, typename Func>
+	static void forEachRule(std::vector<T>& infos, Func&& func)
+	{
+		for (auto& info : infos)
+		{
+			func(info);
+		}
+	}
+
+	template <typename T, typename Func>
+	static void forEachRule(std::map<std::string, std::vector<T>>& map, Func&& func)
+	{
+		for (auto& [key, infos] : map)
+		{
+			forEachRule(infos, func);
+		}
+	}
+
+	// the overlay edits a copy while the passes keep updating the live rules, so the runtime state is carried
+	// over from the live rule with the same ID; writing a stale copy back can't revert what a pass just did
+	template <typename T>
+	static void replaceRules(T& live, const T& edited)
+	{
+		std::unordered_map<std::uint64_t, RuntimeState> states;
+		forEachRule(live, [&states](const auto& info) {
+			if (info.id == 0)
+				return;
+
+			RuntimeState& state = states[info.id];
+			if constexpr (requires { info.isToggled; })
+				state.isToggled = info.isToggled;
+			if constexpr (requires { info.activeToday; })
+				state.activeToday = info.activeToday;
+			});
+
+		live = edited;
+
+		forEachRule(live, [&states](auto& info) {
+			const auto it = states.find(info.id);
+			if (info.id == 0 || it == states.end())
+				return;
+
+			if constexpr (requires { info.isToggled; })
+				info.isToggled = it->second.isToggled;
+			if constexpr (requires { info.activeToday; })
+				info.activeToday = it->second.activeToday;
+			});
+	}
 
 	std::string constructKey(const RE::TESForm* form) const;
 
+	void compileRules();
+
+	// sections added after the first preset version, presets without them still load
+	static bool isOptionalKey(const std::string& key) { return key == "Rules"; }
+
+	// rules are edited from the overlay and evaluated from the game and UI threads
+	mutable std::mutex m_dataLock;
+
+	// a frame can present more than one runtime, only one of them drains
+	std::mutex m_drainLock;
+	std::vector<CommandQueue::Command> m_commandBatch;
+
+	// index + 1 of the pending toggle in m_commandBatch, indexed by effect ID, 0 outside of coalesceToggles
+	std::array<std::uint32_t, EffectTable::s_capacity> m_pendingToggles{};
+	std::uint64_t m_coalescedToggles = 0;
+
+	// set by parseJSONPreset, the render thread holds the queue until the game thread evaluated the new preset
+	enum class PresetSwitch : std::uint8_t
+	{
+		None,
+		Evaluating,
+		Ready
+	};
+	static constexpr std::uint32_t s_maxPresetSwitchHeldFrames = 30; // the game thread may be stalled by a loading screen
+	std::atomic<PresetSwitch> m_presetSwitch{ PresetSwitch::None };
+	std::uint32_t m_presetSwitchHeldFrames = 0;
+	PresetSwitchStats m_presetSwitchStats;
+
 	std::map<std::string, std::vector<MenuToggleInformation>> m_menuToggleInfo;
 	std::map<std::string, std::vector<WeatherToggleInformation>> m_weatherToggleInfo;
 	std::map<std::string, std::vector<InteriorToggleInformation>> m_interiorToggleInfo;
 	std::map<std::string, std::vector<TimeToggleInformation>> m_timeToggleInfo;
+	std::vector<RuleToggleInformation> m_ruleToggleInfo;
+
+	// compiled form of m_ruleToggleInfo, rebuilt whenever the rules change
+	Rules::RuleStore m_ruleStore;
+	std::vector<std::uint64_t> m_ruleResults;
+	bool m_rulesDirty = true;
 
 	// cache for reseting after toggling
-	std::pair<RE::TESForm*, std::vector<TimeToggleInformation>> m_timeToggleCache;
-	std::pair<RE::TESForm*, std::vector<InteriorToggleInformation>> m_interiorToggleCache;
-	std::pair<RE::TESForm*, std::vector<WeatherToggleInformation>> m_weatherToggleCache;
+	ToggleCache m_timeToggleCache;
+	ToggleCache m_interiorToggleCache;
+	ToggleCache m_weatherToggleCache;
+	std::uint64_t m_lastRuleID = 0;
+
+	// minutes where any time rule flips, the time pass sleeps until the next one
+	GameTime::MinuteMask m_timeBoundaries{};
+
+	// indexed by TickScheduler::Pass, the state each pass saw on its previous evaluation
+	std::array<PassFingerprint, static_cast<std::size_t>(TickScheduler::Pass::kTotal)> m_fingerprints;
+
+	// the day activeToday of the time rules was computed for
+	std::uint32_t m_timeRuleDay = 0;
+	bool m_timeRuleDatesDirty = true;
+
+	// indexed by effect ID, whether any runtime has techniques for it, so lookups from other threads never walk the runtime
+	mutable std::shared_mutex m_effectIndexLock;
+	std::vector<std::uint8_t> m_loadedEffects;
+
+	// how many open menus currently hold each effect, indexed by effect ID
+	std::array<std::uint16_t, EffectTable::s_capacity> m_menuEffectUsage{};
 
 	// INI settings
 	std::string m_lastPresetName = "";
+	bool m_journalEnabled = true;
 
 
 	//Papyrus stuff
@@ -227,5 +556,3 @@ private:
 	template<typename... Args>
 	bool deserializeArbitraryData(const std::string& buf, Args&... args);
 };
-
-extern reshade::api::effect_runtime* s_pRuntime;
\ No newline at end of file
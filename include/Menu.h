@@ -8,12 +8,17 @@ class Menu : public ISingleton<Menu>, public MenuManager
 public:
 	void SettingsMenu();
 
+	// the load button and Papyrus' ApplyProfile both end up here, on the render and the game thread respectively
+	bool loadPreset(const std::string& preset);
+
 private:
 	void SpawnMainPage(ImGuiID dockspaceId);
 	void SpawnMenuSettings(ImGuiID dockspaceId);
 	void SpawnTimeSettings(ImGuiID dockspaceId);
 	void SpawnInteriorSettings(ImGuiID dockspaceId);
 	void SpawnWeatherSettings(ImGuiID dockspaceId);
+	void SpawnRuleSettings(ImGuiID dockspaceId);
+	void SpawnPerformancePage(ImGuiID dockspaceId);
 private:
 	void SaveFile();
 
@@ -21,9 +26,15 @@ private:
 	void AddNewWeather(std::map<std::string, std::vector<WeatherToggleInformation>>& updatedInfoList);
 	void AddNewInterior(std::map<std::string, std::vector<InteriorToggleInformation>>& updatedInfoList);
 	void AddNewTime(std::map<std::string, std::vector<TimeToggleInformation>>& updatedInfoList);
+	void AddNewRule(std::vector<RuleToggleInformation>& updatedInfoList);
 	void ClampInputValue(char* inputStr, int maxVal);
-	void EditValues(const std::string& effectName, std::vector<UniformInfo>& toReturn);
-	void HandleEffectEditing(std::vector<UniformInfo>& targetUniforms, std::string& currentEditingEffect, int& editingEffectIndex);
+	bool TimeInput(const std::string& id, std::uint16_t& minuteOfDay);
+	bool TimingInput(const std::string& id, ToggleTiming& timing);
+	bool MultiSelectCombo(const std::string& label, std::vector<std::string>& selected, const std::vector<std::string>& options);
+	bool DateConditions(const std::string& id, TimeToggleInformation& info);
+	// both return whether a uniform value was edited or added this frame
+	bool EditValues(const std::string& effectName, std::vector<UniformInfo>& toReturn);
+	bool HandleEffectEditing(std::vector<UniformInfo>& targetUniforms, std::string& currentEditingEffect, int& editingEffectIndex);
 
 	void EffectOptions();
 private:
@@ -40,6 +51,8 @@ private:
 	std::vector<std::string> m_worldSpaces = Manager::GetSingleton()->enumerateWorldSpaces();
 	std::vector<std::string> m_interiorCells = Manager::GetSingleton()->enumerateInteriorCells();
 	std::vector<std::string> m_weathers = Manager::GetSingleton()->enumerateWeathers();
+	std::vector<std::string> m_ruleLocations = Rules::s_locationOptions;
+	std::vector<std::string> m_ruleMenus = Rules::s_menuOptions;
 
 	std::string m_currentEditingEffect{};
 	int m_editingEffectIndex = -1;
@@ -51,10 +64,27 @@ private:
 	ImVec4 m_lastMessageColor;
 	std::string m_lastMessage;
 
+	// the result of the last loadPreset, picked up by the main page on the render thread
+	struct LoadedPreset
+	{
+		std::string name;
+		bool success = false;
+		double duration = 0.0;
+	};
+	void takeLoadedPreset();
+	std::mutex m_loadedPresetLock;
+	std::optional<LoadedPreset> m_loadedPreset;
+
+	std::vector<Rules::BenchmarkResult> m_ruleBenchmark;
+	std::future<std::vector<Rules::BenchmarkResult>> m_ruleBenchmarkTask;
+	std::vector<Manager::CompileBenchmarkResult> m_compileBenchmark;
+	std::future<std::vector<Manager::CompileBenchmarkResult>> m_compileBenchmarkTask;
+
 	bool m_saveConfigPopupOpen = false;
 	bool m_openSettingsMenu = false;
 	bool m_showMenuSettings = false;
 	bool m_showTimeSettings = false;
 	bool m_showInteriorSettings = false;
 	bool m_showWeatherSettings = false;
+	bool m_showRuleSettings = false;
 };
\ No newline at end of file
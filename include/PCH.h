@@ -6,6 +6,8 @@
 #include <spdlog/sinks/basic_file_sink.h>
 #include "SimpleIni/SimpleIni.h"
 #include <unordered_set>
+#include <shared_mutex>
+#include <future>
 
 #include "Plugin.h"
 
@@ -9,6 +9,9 @@ namespace Papyrus
 	bool IsReShadeInstalled(VM*, StackID, RE::StaticFunctionTag*);
 	void ToggleEffect(VM* vm, StackID stackID, RE::StaticFunctionTag*, RE::BSFixedString effectName, bool state);
 	void ToggleReShade(VM* vm, StackID stackID, RE::StaticFunctionTag*, bool state);
+	void ToggleEffects(VM* vm, StackID stackID, RE::StaticFunctionTag*, std::vector<RE::BSFixedString> effectNames, std::vector<bool> states);
+	void SetUniformFloat(VM* vm, StackID stackID, RE::StaticFunctionTag*, RE::BSFixedString effectName, RE::BSFixedString uniformName, std::vector<float> values);
+	bool ApplyProfile(VM* vm, StackID stackID, RE::StaticFunctionTag*, RE::BSFixedString presetName);
 
 	bool Bind(VM* vm);
 }
\ No newline at end of file
@@ -0,0 +1,38 @@
+#pragma once
+
+// The game state a toggle pass reads, packed into a few words. Most ticks find the same worldspace,
+// weather and time segment as the previous one, a pass that sees the fingerprint of its previous
+// evaluation returns before building keys or walking its rules. Anything that changes the rules
+// themselves invalidates the fingerprint.
+
+class PassFingerprint
+{
+public:
+	struct Value
+	{
+		RE::FormID form = 0; // worldspace, or the cell the time rules are keyed on
+		std::uint32_t detail = 0; // weather form ID, day of the time rules, packed rules state
+		std::uint16_t bucket = 0; // next time boundary, constant until a time rule can flip
+		bool paused = false;
+		bool valid = true;
+
+		bool operator==(const Value&) const = default;
+	};
+
+	// true if nothing changed since the previous evaluation, the pass can return
+	bool matches(const Value& value);
+
+	void invalidate() { m_previous.valid = false; }
+
+	std::uint64_t getHits() const { return m_hits.load(std::memory_order_relaxed); }
+	std::uint64_t getMisses() const { return m_misses.load(std::memory_order_relaxed); }
+	float getHitRate() const;
+
+	void resetCounters();
+
+private:
+	Value m_previous{ .valid = false };
+
+	std::atomic<std::uint64_t> m_hits{ 0 };
+	std::atomic<std::uint64_t> m_misses{ 0 };
+};
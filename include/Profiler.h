@@ -0,0 +1,108 @@
+#pragma once
+
+// Scoped timing zones for the hot paths of the plugin.
+// The profiler only exists in builds configured with ENABLE_PROFILER, otherwise PROFILE_ZONE expands to nothing.
+
+#define PROFILE_CONCAT_IMPL(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_IMPL(a, b)
+
+#ifndef ENABLE_PROFILER
+#define PROFILE_ZONE(zone) ((void)0)
+#else
+#define PROFILE_ZONE(zone) const Profiler::ScopedZone PROFILE_CONCAT(profileZone, __LINE__){ zone }
+
+class Profiler : public ISingleton<Profiler>
+{
+public:
+	static constexpr std::uint32_t s_windowSize = 512;
+
+	enum class Zone : std::uint8_t
+	{
+		MainUpdate,
+		ProcessEvent,
+		ToggleEffectMenu,
+		ToggleEffectWeather,
+		ToggleEffectTime,
+		ToggleEffectInterior,
+		ToggleEffectRules,
+		ToggleEffect,
+		ParsePreset,
+		SerializePreset,
+		SettingsMenu,
+		ExecuteCommands,
+		AnimateUniforms,
+		UpdateTransitions,
+		EvaluateBindings,
+
+		kTotal
+	};
+
+	struct ZoneStats
+	{
+		float minMs = 0.f;
+		float avgMs = 0.f;
+		float p99Ms = 0.f;
+		std::uint32_t sampleCount = 0;
+	};
+
+	class ScopedZone
+	{
+	public:
+		explicit ScopedZone(Zone zone) : m_zone(zone), m_start(std::chrono::steady_clock::now()) {}
+		~ScopedZone() { Profiler::GetSingleton()->record(m_zone, std::chrono::steady_clock::now() - m_start); }
+
+		ScopedZone(const ScopedZone&) = delete;
+		ScopedZone& operator=(const ScopedZone&) = delete;
+
+	private:
+		Zone m_zone;
+		std::chrono::steady_clock::time_point m_start;
+	};
+
+	static const char* getZoneName(Zone zone);
+
+	// producer side, called from whichever thread closed the zone
+	void record(Zone zone, std::chrono::steady_clock::duration duration);
+
+	// consumer side, drains all thread buffers into the rolling windows (render thread)
+	void collect();
+
+	ZoneStats getStats(Zone zone) const;
+	std::uint64_t getDroppedSamples() const { return m_droppedSamples.load(std::memory_order_relaxed); }
+
+	void reset();
+
+private:
+	static constexpr std::uint32_t s_threadBufferSize = 4096; // power of two
+
+	struct Sample
+	{
+		Zone zone;
+		std::uint32_t durationNs;
+	};
+
+	// single producer (owning thread), single consumer (collect)
+	struct ThreadBuffer
+	{
+		std::array<Sample, s_threadBufferSize> samples{};
+		alignas(64) std::atomic<std::uint32_t> head{ 0 };
+		alignas(64) std::atomic<std::uint32_t> tail{ 0 };
+		std::atomic<bool> retired{ false }; // set when the owning thread exits, collect frees it after the last drain
+	};
+
+	struct Window
+	{
+		std::array<std::uint32_t, s_windowSize> durationsNs{};
+		std::uint32_t next = 0;
+		std::uint32_t count = 0;
+	};
+
+	ThreadBuffer* getThreadBuffer();
+
+	std::mutex m_registryLock; // only taken the first time a thread records a zone
+	std::vector<std::unique_ptr<ThreadBuffer>> m_threadBuffers;
+	std::atomic<std::uint64_t> m_droppedSamples{ 0 };
+
+	std::array<Window, static_cast<std::size_t>(Zone::kTotal)> m_windows{};
+};
+#endif
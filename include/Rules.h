@@ -0,0 +1,105 @@
+#pragma once
+
+struct RuleToggleInformation;
+
+// Compound rules: every condition compiles into bit masks over one packed game state word,
+// so checking a rule is a few AND/compare operations and a batch of rules is a flat loop.
+
+namespace Rules
+{
+	enum GameStateBit : std::uint8_t
+	{
+		kHour = 0, // one bit per hour, 0-23
+		kInterior = 24,
+		kInMenu = 25,
+		kPleasant = 26,
+		kCloudy = 27,
+		kRainy = 28,
+		kSnow = 29,
+		kNoWeatherClass = 30 // no weather or one without classification, keeps the weather group non-empty
+	};
+
+	// every group has exactly one or more bits set in any captured state,
+	// so an unconstrained group simply uses the full group mask
+	inline constexpr std::uint32_t kHourBits = (1u << 24) - 1;
+	inline constexpr std::uint32_t kWeatherBits = 0x1Fu << kPleasant;
+
+	// names used in the preset and the UI
+	inline const std::vector<std::string> s_locationOptions = { "Any", "Interior", "Exterior" };
+	inline const std::vector<std::string> s_menuOptions = { "Any", "Open", "Closed" };
+	inline const std::vector<std::string> s_weatherOptions = { "Pleasant", "Cloudy", "Rainy", "Snow" };
+
+	// a rule matches when (state & mustMask) == mustValue and it hits at least one bit of every any-of group
+	struct CompiledRule
+	{
+		std::uint32_t mustMask = 0;
+		std::uint32_t mustValue = 0;
+		std::uint32_t hourMask = kHourBits;
+		std::uint32_t weatherMask = kWeatherBits;
+	};
+
+	// structure of arrays, padded to a multiple of s_lanes with rules that never match
+	class RuleStore
+	{
+	public:
+		static constexpr size_t s_lanes = 16;
+
+		void clear();
+		void reserve(size_t count);
+		void add(const CompiledRule& rule);
+
+		size_t size() const { return m_count; }
+		size_t resultWords() const { return (m_count + 63) / 64; }
+
+		const std::uint32_t* mustMask() const { return m_mustMask.data(); }
+		const std::uint32_t* mustValue() const { return m_mustValue.data(); }
+		const std::uint32_t* hourMask() const { return m_hourMask.data(); }
+		const std::uint32_t* weatherMask() const { return m_weatherMask.data(); }
+
+		size_t paddedSize() const { return m_mustMask.size(); }
+
+	private:
+		void pad();
+
+		size_t m_count = 0;
+		std::vector<std::uint32_t> m_mustMask;
+		std::vector<std::uint32_t> m_mustValue;
+		std::vector<std::uint32_t> m_hourMask;
+		std::vector<std::uint32_t> m_weatherMask;
+	};
+
+	enum class Evaluator : std::uint8_t
+	{
+		Scalar,
+		SSE2,
+		AVX2
+	};
+
+	std::uint32_t captureGameState();
+
+	CompiledRule compile(const RuleToggleInformation& rule);
+
+	inline bool matches(const CompiledRule& rule, const std::uint32_t state)
+	{
+		return ((state & rule.mustMask) == rule.mustValue) & ((state & rule.hourMask) != 0) & ((state & rule.weatherMask) != 0);
+	}
+
+	// the widest evaluator the CPU supports, checked once
+	Evaluator getBestEvaluator();
+	const char* getEvaluatorName(Evaluator evaluator);
+
+	// writes one bit per rule into results, which needs store.resultWords() words
+	void evaluate(const RuleStore& store, std::uint32_t state, std::span<std::uint64_t> results, Evaluator evaluator = getBestEvaluator());
+
+	struct BenchmarkResult
+	{
+		size_t ruleCount = 0;
+		double scalarUs = 0.0;
+		double sseUs = 0.0;
+		double avxUs = 0.0; // 0 if AVX2 isn't available
+		bool resultsMatch = true;
+	};
+
+	// random rule sets of 1k, 10k and 100k rules, average time of one full evaluation per evaluator
+	std::vector<BenchmarkResult> runBenchmark();
+}
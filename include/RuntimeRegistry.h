@@ -0,0 +1,71 @@
+#pragma once
+#include "Utils.h"
+#include "EffectTable.h"
+#include "UniformBaseline.h"
+
+// Every live effect runtime (one per swapchain, two with VR) together with its resolved handles.
+// Init, destroy and command execution run on the render thread; the game and overlay threads only reach
+// a runtime through withPrimary, which holds the lock so it can't be destroyed while in use.
+
+class RuntimeRegistry : public ISingleton<RuntimeRegistry>
+{
+public:
+	struct Entry
+	{
+		reshade::api::effect_runtime* runtime = nullptr;
+
+		// resolved lazily on first use, dropped when the runtime reloads its effects
+		std::vector<std::vector<reshade::api::effect_technique>> techniques; // indexed by effect ID
+		std::vector<std::uint8_t> techniquesResolved;
+		struct Uniform
+		{
+			reshade::api::effect_uniform_variable variable{ 0 };
+			UniformBaseline::Value current; // last value written or read through the queue, the journal's old value
+		};
+		std::unordered_map<std::string, Uniform, Utils::StringHash, std::equal_to<>> uniforms;
+
+		// values before the first rule override, indexed by UniformBaseline handle, survive reloads
+		std::vector<UniformBaseline::Value> baselines;
+
+		// indexed by effect ID, already sent through a compile, dropped on reload
+		std::vector<std::uint8_t> prewarmed;
+
+		const std::vector<reshade::api::effect_technique>& getTechniques(EffectTable::ID effect);
+		Uniform& getUniform(EffectTable::ID effect, const char* uniform);
+	};
+
+	void add(reshade::api::effect_runtime* runtime);
+	void remove(reshade::api::effect_runtime* runtime);
+	void invalidate(reshade::api::effect_runtime* runtime);
+
+	// the runtime the overlay and enumeration work with, the first one still alive
+	reshade::api::effect_runtime* getPrimary() const;
+
+	size_t size() const;
+
+	// calls func with the primary runtime under the lock, false when there is none
+	template <typename Func>
+	bool withPrimary(Func&& func) const
+	{
+		std::scoped_lock lock(m_lock);
+		if (m_entries.empty())
+			return false;
+
+		func(m_entries.front()->runtime);
+		return true;
+	}
+
+	template <typename Func>
+	void forEach(Func&& func)
+	{
+		std::scoped_lock lock(m_lock);
+		for (auto& entry : m_entries)
+		{
+			func(*entry);
+		}
+	}
+
+private:
+	mutable std::mutex m_lock;
+	std::vector<std::unique_ptr<Entry>> m_entries;
+};
@@ -0,0 +1,63 @@
+#pragma once
+#include "RuntimeRegistry.h"
+#include "CommandQueue.h"
+
+// What one runtime shows right before a preset switch: the enabled state of every known effect's
+// techniques and the values of the uniforms the switch writes. Commands are folded in queue order,
+// a later one replaces an earlier one for the same technique or uniform, and only what differs from
+// the snapshot has to reach the runtime.
+
+class StateSnapshot
+{
+public:
+	explicit StateSnapshot(RuntimeRegistry::Entry& entry);
+
+	void fold(const CommandQueue::Command& command);
+
+	// the surviving commands in queue order, changes is false for the ones that would write what is already there
+	template <typename Func>
+	void forEach(Func&& func) const
+	{
+		for (const auto& folded : m_commands)
+		{
+			if (!folded.superseded)
+			{
+				func(folded.command, folded.changes);
+			}
+		}
+	}
+
+private:
+	static constexpr std::uint8_t s_unknownState = 2; // effect has no techniques on this runtime
+	static constexpr std::uint8_t s_mixedState = 3; // its techniques are not all enabled or all disabled, a toggle always writes
+
+	struct Folded
+	{
+		CommandQueue::Command command;
+		bool superseded = false;
+		bool changes = true;
+	};
+
+	struct Uniform
+	{
+		std::int32_t latest = 0; // index into m_commands
+		bool captured = false;
+		bool touched = false; // an earlier command of the batch was dropped for this one
+		Journal::ValueType valueType = Journal::ValueType::None;
+		std::uint8_t valueCount = 0;
+		std::uint32_t values[4] = {};
+	};
+
+	// reads the current value on first use, no command of the batch has been applied yet at that point
+	bool holds(Uniform& uniform, const CommandQueue::Command& command, Journal::ValueType valueType, std::uint8_t valueCount, const std::uint32_t* values);
+
+	RuntimeRegistry::Entry& m_entry;
+
+	std::vector<std::uint8_t> m_techniques; // indexed by effect ID
+	bool m_effectsState = true;
+
+	std::vector<Folded> m_commands;
+	std::vector<std::int32_t> m_latestToggle; // indexed by effect ID, -1 if none
+	std::int32_t m_latestReShade = -1;
+	std::unordered_map<std::string, Uniform, Utils::StringHash, std::equal_to<>> m_uniforms;
+};
@@ -0,0 +1,54 @@
+#pragma once
+
+// Decides when the periodic rule passes of MainUpdate run. After each run a pass reports when its
+// result could change next (a time window boundary, the end of a weather transition, never while
+// nothing can move), clamped to the limits from the INI. The hook compares one time point per frame
+// and only does work once a pass is due. Events outside of the schedule wake passes early.
+
+class TickScheduler : public ISingleton<TickScheduler>
+{
+public:
+	using Clock = std::chrono::steady_clock;
+
+	enum class Pass : std::uint8_t
+	{
+		Weather,
+		Time,
+		Rules,
+
+		kTotal
+	};
+
+	// only a wake runs the pass again
+	static constexpr Clock::duration s_never = Clock::duration::max();
+
+	// game thread, once per frame
+	bool anyDue(Clock::time_point now) const { return now.time_since_epoch().count() >= m_nextDue.load(std::memory_order_acquire); }
+	bool isDue(Pass pass, Clock::time_point now) const;
+
+	// game thread, right after the pass ran
+	void schedule(Pass pass, Clock::time_point now, Clock::duration delay);
+
+	// any thread, something the schedule couldn't predict happened (preset loaded, cell changed, menu closed)
+	void wake(Pass pass);
+	void wakeAll();
+
+	// milliseconds until the pass runs again, -1 for never
+	long long getRemainingMs(Pass pass, Clock::time_point now) const;
+
+	std::chrono::milliseconds getMinInterval() const { return m_minInterval; }
+	std::chrono::milliseconds getMaxInterval() const { return m_maxInterval; }
+	void setIntervals(std::chrono::milliseconds minInterval, std::chrono::milliseconds maxInterval);
+
+	static const char* getPassName(Pass pass);
+
+private:
+	void updateNextDue();
+
+	mutable std::mutex m_lock;
+	std::array<Clock::rep, static_cast<size_t>(Pass::kTotal)> m_due{}; // zero = due now
+	std::atomic<Clock::rep> m_nextDue{ 0 };
+
+	std::chrono::milliseconds m_minInterval{ 100 };
+	std::chrono::milliseconds m_maxInterval{ 2000 };
+};
@@ -0,0 +1,34 @@
+#pragma once
+#include "EffectTable.h"
+
+// The toggles a worldspace or cell currently holds, keyed by dense rule ID.
+// Entries only keep what is needed to revert a toggle, activation and release are O(1).
+
+class ToggleCache
+{
+public:
+	struct Entry
+	{
+		std::uint64_t ruleID = 0;
+		EffectTable::ID effect = EffectTable::s_invalidID;
+		bool state = true;
+	};
+
+	RE::TESForm* getForm() const { return m_form; }
+	void setForm(RE::TESForm* form) { m_form = form; }
+
+	bool isActive(std::uint64_t ruleID) const { return ruleID < m_slots.size() && m_slots[ruleID] != 0; }
+
+	void activate(std::uint64_t ruleID, EffectTable::ID effect, bool state);
+	void release(std::uint64_t ruleID);
+
+	// forgets the form as well
+	void clear();
+
+	const std::vector<Entry>& getEntries() const { return m_entries; }
+
+private:
+	RE::TESForm* m_form = nullptr;
+	std::vector<Entry> m_entries;
+	std::vector<std::uint32_t> m_slots; // rule ID -> position in m_entries + 1, 0 if not active
+};
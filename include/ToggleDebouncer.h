@@ -0,0 +1,67 @@
+#pragma once
+#include "Journal.h"
+#include "EffectTable.h"
+
+// Holds back technique flips of rules with a debounce window or a minimum on/off duration.
+// A flip waits until the window passed without the rule flipping back, and until the effect kept its
+// previous state for the minimum duration; flipping back in the meantime cancels it. Pending flips sit in a
+// min-heap on their due time, so every frame only looks at the top entry. Replaced flips stay in the heap
+// and are dropped by generation once they reach the top.
+
+struct ToggleTiming
+{
+	std::uint32_t debounceMs = 0;
+	std::uint32_t minDurationMs = 0;
+
+	bool isImmediate() const { return debounceMs == 0 && minDurationMs == 0; }
+};
+
+class ToggleDebouncer : public ISingleton<ToggleDebouncer>
+{
+public:
+	using Clock = std::chrono::steady_clock;
+
+	// any thread, false if the flip has to wait, forwarded by update once it is due
+	bool request(EffectTable::ID effect, bool state, Journal::Source source, std::uint64_t ruleID, const ToggleTiming& timing);
+
+	// game thread, once per frame
+	void update();
+
+	void clear();
+
+	size_t getPendingCount() const { return m_pendingCount.load(std::memory_order_relaxed); }
+	std::uint64_t getCancelledCount() const { return m_cancelledCount.load(std::memory_order_relaxed); }
+
+private:
+	struct Slot
+	{
+		bool known = false; // applied is valid
+		bool applied = false;
+		Clock::time_point appliedAt{};
+
+		bool pending = false;
+		bool pendingState = false;
+		Journal::Source source = Journal::Source::Unknown;
+		std::uint64_t ruleID = 0;
+		std::uint32_t generation = 0;
+	};
+
+	struct Timer
+	{
+		Clock::time_point due;
+		EffectTable::ID effect;
+		std::uint32_t generation;
+
+		bool operator>(const Timer& other) const { return due > other.due; }
+	};
+
+	void cancel(Slot& slot);
+
+	mutable std::mutex m_lock;
+	std::vector<Slot> m_slots; // indexed by effect ID
+	std::priority_queue<Timer, std::vector<Timer>, std::greater<>> m_timers;
+	std::atomic<Clock::rep> m_nextDue{ std::numeric_limits<Clock::rep>::max() };
+
+	std::atomic<size_t> m_pendingCount{ 0 };
+	std::atomic<std::uint64_t> m_cancelledCount{ 0 };
+};
@@ -0,0 +1,130 @@
+#pragma once
+#include "ToggleCache.h"
+
+// A condition source keyed by the form the player is in, a worldspace or a cell. The rules of the
+// current form are toggled while their condition holds, and what the previous form toggled is reverted
+// once the form changes, unless a rule of the new form wants the same.
+//
+// Policy supplies what differs between the sources:
+//   Info              the rule type stored per form key
+//   Context           what the host captured this evaluation, form is null where the source doesn't apply
+//   s_source          journal source of the toggles
+//   s_tracksToggled   whether rules are switched back off while the form stays, through Info::isToggled
+//   isWanted          the condition of one rule
+// Host is the Manager, evaluate only runs under its data lock.
+
+template <typename Policy>
+class ToggleSource
+{
+public:
+	using Info = typename Policy::Info;
+	using InfoMap = std::map<std::string, std::vector<Info>>;
+	using Context = typename Policy::Context;
+
+	template <typename Host>
+	static void evaluate(Host& host, InfoMap& infoMap, ToggleCache& cache, const Context& context)
+	{
+		RE::TESForm* form = context.form;
+		const auto it = infoMap.find(host.constructKey(form));
+		const auto cachedForm = cache.getForm();
+
+		// uniforms of the previous form are released after the new rules took hold,
+		// so one both share isn't restored in between
+		std::vector<std::uint64_t> previousRules;
+		const auto releasePrevious = [&previousRules]() {
+			for (const auto ruleID : previousRules)
+			{
+				Host::releaseRuleUniforms(ruleID);
+			}
+			};
+
+		if (!form || cachedForm && cachedForm->formID != form->formID)
+		{
+			if (cachedForm)
+			{
+				for (const auto& entry : cache.getEntries())
+				{
+					if (!form || allowRevert(entry, it, infoMap, context)) // change effect state back to original if it was toggled before
+					{
+						host.toggleEffect(entry.effect, !entry.state, Policy::s_source, entry.ruleID);
+					}
+					previousRules.push_back(entry.ruleID);
+				}
+				cache.clear();
+
+				// the previous form's rules start over when the player comes back, its cache is gone
+				if constexpr (Policy::s_tracksToggled)
+				{
+					if (const auto previous = infoMap.find(host.constructKey(cachedForm)); previous != infoMap.end())
+					{
+						for (auto& info : previous->second)
+						{
+							info.isToggled = false;
+						}
+					}
+				}
+			}
+
+			if (!form)
+			{
+				releasePrevious();
+				return;
+			}
+		}
+
+		if (it == infoMap.end())
+		{
+			releasePrevious();
+			return;
+		}
+
+		for (auto& info : it->second)
+		{
+			if (Policy::isWanted(info, context))
+			{
+				host.toggleEffect(info.effectID, info.state, Policy::s_source, info.id, info.timing);
+				cache.activate(info.id, info.effectID, info.state);
+				if constexpr (Policy::s_tracksToggled)
+				{
+					info.isToggled = true;
+				}
+
+				host.applyRuleUniforms(info.effectID, info.uniforms, Policy::s_source, info.id);
+			}
+			else if constexpr (Policy::s_tracksToggled)
+			{
+				if (info.isToggled)
+				{
+					host.toggleEffect(info.effectID, !info.state, Policy::s_source, info.id, info.timing);
+					info.isToggled = false;
+					cache.release(info.id);
+
+					Host::releaseRuleUniforms(info.id);
+				}
+			}
+		}
+		cache.setForm(form);
+
+		releasePrevious();
+	}
+
+private:
+	// false if a rule of the new form holds the effect in the cached state anyway
+	static bool allowRevert(const ToggleCache::Entry& entry, const typename InfoMap::iterator& it, const InfoMap& infoMap, const Context& context)
+	{
+		if (it == infoMap.end())
+			return true;
+
+		for (const auto& newInfo : it->second)
+		{
+			if (entry.effect == newInfo.effectID &&
+				entry.state == newInfo.state &&
+				Policy::isWanted(newInfo, context))
+			{
+				return false;
+			}
+		}
+
+		return true;
+	}
+};
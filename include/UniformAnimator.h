@@ -0,0 +1,68 @@
+#pragma once
+#include "Journal.h"
+#include "EffectTable.h"
+
+// Keyframed float uniforms that follow the in-game time of day.
+// Tracks are sampled into a fixed lookup table on load, so a frame only blends two table entries,
+// and a value is only written once it moved further than the configured epsilon.
+
+struct Keyframe
+{
+	float hour = 0.f; // 0-24
+	std::vector<float> values;
+};
+
+class UniformAnimator : public ISingleton<UniformAnimator>
+{
+public:
+	static constexpr std::uint32_t s_samples = 256; // over 24 hours, about 5.6 in-game minutes apart
+
+	enum class Interpolation : std::uint8_t
+	{
+		Linear,
+		Cubic // Catmull-Rom, wraps around midnight like the linear one
+	};
+
+	// names used in the preset
+	static Interpolation getInterpolation(std::string_view name);
+
+	struct Curve
+	{
+		std::uint8_t valueCount = 0;
+		std::array<std::array<float, 4>, s_samples> table{};
+	};
+
+	// nullptr if there is nothing to animate
+	static std::shared_ptr<const Curve> buildCurve(const std::vector<Keyframe>& keyframes, Interpolation interpolation);
+
+	// replaces whatever drove the uniform before, a constant write has to unbind it
+	void bind(EffectTable::ID effect, const std::string& uniform, std::shared_ptr<const Curve> curve, Journal::Source source, std::uint64_t ruleID);
+	void unbind(EffectTable::ID effect, const std::string& uniform);
+	void clear();
+
+	// game thread, samples every bound curve for the current in-game hour
+	void update();
+
+	float getEpsilon() const { return m_epsilon.load(std::memory_order_relaxed); }
+	void setEpsilon(const float epsilon) { m_epsilon.store(std::max(epsilon, 0.f), std::memory_order_relaxed); }
+
+	size_t size() const { return m_count.load(std::memory_order_relaxed); }
+
+private:
+	struct Binding
+	{
+		EffectTable::ID effect = EffectTable::s_invalidID;
+		std::string uniform;
+		std::shared_ptr<const Curve> curve;
+		Journal::Source source = Journal::Source::Unknown;
+		std::uint64_t ruleID = 0;
+		std::array<float, 4> lastWritten{};
+		bool written = false;
+	};
+
+	mutable std::mutex m_lock;
+	std::vector<Binding> m_bindings;
+	std::atomic<size_t> m_count{ 0 }; // lets update bail out without the lock
+
+	std::atomic<float> m_epsilon{ 0.001f };
+};
@@ -0,0 +1,46 @@
+#pragma once
+#include "Journal.h"
+#include "EffectTable.h"
+
+// Remembers what a uniform looked like before the first rule overrode it and puts it back
+// once the last rule holding it deactivates. Uniforms held by rules get a dense handle,
+// so holder counts and the per-runtime captured values are flat arrays indexed by it.
+
+class UniformBaseline : public ISingleton<UniformBaseline>
+{
+public:
+	using Handle = std::uint32_t;
+	static constexpr Handle s_invalidHandle = std::numeric_limits<Handle>::max();
+
+	// the original value as read from one runtime, kept in RuntimeRegistry::Entry
+	struct Value
+	{
+		bool captured = false;
+		Journal::ValueType valueType = Journal::ValueType::None;
+		std::uint8_t valueCount = 0;
+		std::uint32_t values[4] = {};
+	};
+
+	// game side, a rule starts or stops overriding a uniform
+	void hold(std::uint64_t ruleID, EffectTable::ID effect, const std::string& uniform);
+	void release(std::uint64_t ruleID);
+
+	// render side, s_invalidHandle for uniforms no rule ever held
+	Handle find(EffectTable::ID effect, std::string_view uniform) const;
+
+	size_t getHeldCount() const { return m_heldCount.load(std::memory_order_relaxed); }
+
+private:
+	Handle intern(EffectTable::ID effect, const std::string& uniform);
+
+	static std::string makeKey(EffectTable::ID effect, std::string_view uniform) { return std::format("{}|{}", effect, uniform); }
+
+	mutable std::shared_mutex m_handleLock; // the render thread only looks up
+	std::unordered_map<std::string, Handle, Utils::StringHash, std::equal_to<>> m_handles;
+
+	std::mutex m_holdLock;
+	std::vector<std::uint16_t> m_holders; // indexed by handle
+	std::vector<std::pair<EffectTable::ID, std::string>> m_uniforms; // indexed by handle
+	std::unordered_map<std::uint64_t, std::vector<Handle>> m_heldBy; // rule ID -> handles
+	std::atomic<size_t> m_heldCount{ 0 };
+};
@@ -0,0 +1,102 @@
+#pragma once
+#include "Journal.h"
+#include "EffectTable.h"
+
+// Drives float uniforms from game variables, e.g. a vignette that follows the player's health.
+// Every binding compiles into a few accumulator instructions; all of them live in one program that
+// is run once per frame, and a binding only executes when the source it reads has changed.
+
+struct UniformBinding
+{
+	std::string source = "None"; // see UniformBindings::s_sourceOptions
+	std::string global{}; // editor ID, only for the Global source
+
+	// value * scale + offset, then clamped
+	float scale = 1.f;
+	float offset = 0.f;
+	float min = 0.f;
+	float max = 1.f;
+
+	bool isActive() const { return !source.empty() && source != "None"; }
+};
+
+class UniformBindings : public ISingleton<UniformBindings>
+{
+public:
+	// names used in the preset
+	inline static const std::vector<std::string> s_sourceOptions = { "None", "Health", "Magicka", "Stamina", "Submerged", "Hour", "Global" };
+
+	// replaces whatever drove the uniform before, a constant write has to unbind it
+	void bind(EffectTable::ID effect, const std::string& uniform, const UniformBinding& binding, Journal::Source source, std::uint64_t ruleID);
+	void unbind(EffectTable::ID effect, const std::string& uniform);
+	void clear();
+
+	// game thread, samples the sources and runs the bindings whose source advanced
+	void update();
+
+	size_t size() const { return m_count.load(std::memory_order_relaxed); }
+
+private:
+	enum class SourceType : std::uint8_t
+	{
+		Health,
+		Magicka,
+		Stamina,
+		Submerged,
+		Hour,
+		Global
+	};
+
+	enum class Op : std::uint8_t
+	{
+		Load, // acc = sources[slot].value
+		Mul, // acc *= a
+		Add, // acc += a
+		Clamp, // acc = clamp(acc, a, b)
+		Store // results[slot] = acc
+	};
+
+	struct Instruction
+	{
+		Op op;
+		std::uint16_t slot = 0;
+		float a = 0.f;
+		float b = 0.f;
+	};
+
+	struct Source
+	{
+		SourceType type;
+		RE::TESGlobal* global = nullptr;
+		float value = 0.f;
+		std::uint32_t generation = 0; // bumped whenever value changes
+	};
+
+	struct Binding
+	{
+		EffectTable::ID effect = EffectTable::s_invalidID;
+		std::string uniform;
+		UniformBinding expression;
+		Journal::Source source = Journal::Source::Unknown;
+		std::uint64_t ruleID = 0;
+
+		// filled in by compile
+		std::uint16_t sourceSlot = 0;
+		std::uint32_t codeBegin = 0;
+		std::uint32_t codeEnd = 0;
+		std::uint32_t seenGeneration = 0;
+		bool written = false;
+	};
+
+	static float readSource(const Source& source);
+
+	// rebuilds the source table and the program, called with m_lock held
+	void compile();
+
+	mutable std::mutex m_lock;
+	std::vector<Binding> m_bindings;
+	std::vector<Source> m_sources;
+	std::vector<Instruction> m_program;
+	std::vector<float> m_results;
+	std::atomic<size_t> m_count{ 0 };
+};
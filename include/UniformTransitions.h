@@ -0,0 +1,65 @@
+#pragma once
+#include "Journal.h"
+#include "EffectTable.h"
+
+// Cross-fades float uniforms to new rule values instead of snapping them.
+// Transitions are kept as structure of arrays with four lanes each, so every frame blends all of them
+// in one SSE pass; with nothing in flight update returns before touching any state.
+
+class UniformTransitions : public ISingleton<UniformTransitions>
+{
+public:
+	// snaps if the previous value is unknown, the duration is zero or nothing changed
+	void setUniform(EffectTable::ID effect, const std::string& uniform, const float* values, size_t count, Journal::Source source, std::uint64_t ruleID);
+
+	// something else drives the uniform now, drop its transition and remembered value
+	void cancel(EffectTable::ID effect, const std::string& uniform);
+	void clear();
+
+	// game thread, advances and writes every transition in flight
+	void update();
+
+	float getDuration() const { return m_duration.load(std::memory_order_relaxed); }
+	void setDuration(const float seconds) { m_duration.store(std::max(seconds, 0.f), std::memory_order_relaxed); }
+
+	bool isFollowingWeather() const { return m_followWeather.load(std::memory_order_relaxed); }
+	void setFollowingWeather(const bool state) { m_followWeather.store(state, std::memory_order_relaxed); }
+
+	size_t size() const { return m_count.load(std::memory_order_relaxed); }
+
+private:
+	static constexpr size_t s_lanes = 4;
+
+	struct Transition
+	{
+		std::string key;
+		EffectTable::ID effect = EffectTable::s_invalidID;
+		std::string uniform;
+		Journal::Source source = Journal::Source::Unknown;
+		std::uint64_t ruleID = 0;
+		std::uint8_t valueCount = 0;
+		bool followWeather = false;
+		std::chrono::steady_clock::time_point start;
+		float duration = 0.f;
+	};
+
+	static std::string makeKey(EffectTable::ID effect, const std::string& uniform) { return std::format("{}|{}", effect, uniform); }
+
+	void removeTransition(size_t index);
+
+	mutable std::mutex m_lock;
+
+	// parallel arrays, m_from/m_to/m_values hold s_lanes floats per transition
+	std::vector<Transition> m_transitions;
+	std::vector<float> m_progress;
+	std::vector<float> m_from;
+	std::vector<float> m_to;
+	std::vector<float> m_values;
+	std::atomic<size_t> m_count{ 0 };
+
+	// last value written per uniform, where the next transition starts from
+	std::unordered_map<std::string, std::array<float, s_lanes>, Utils::StringHash, std::equal_to<>> m_known;
+
+	std::atomic<float> m_duration{ 2.f };
+	std::atomic<bool> m_followWeather{ true };
+};
@@ -5,9 +5,31 @@ namespace Utils
 	RE::FormID getTrimmedFormID(const RE::TESForm* form);
 	std::string getModName(const RE::TESForm* form);
 	void loadINIStringSetting(const CSimpleIniA& a_ini, const char* a_sectionName, const char* a_settingName, std::string& a_setting);
+	void loadINIBoolSetting(const CSimpleIniA& a_ini, const char* a_sectionName, const char* a_settingName, bool& a_setting);
+	void loadINIIntSetting(const CSimpleIniA& a_ini, const char* a_sectionName, const char* a_settingName, int& a_setting);
+	void loadINIFloatSetting(const CSimpleIniA& a_ini, const char* a_sectionName, const char* a_settingName, float& a_setting);
 	std::string tolower(std::string_view a_str);
 	std::string getEditorID(RE::FormID a_formID);
 	std::string getFormEditorID(const RE::TESForm* a_form);
+
+	// truncating copy into a fixed buffer, always terminated
+	template <std::size_t N>
+	void copyName(char (&dest)[N], const char* src)
+	{
+		if (!src)
+			return;
+
+		const std::size_t length = strnlen(src, N - 1);
+		std::memcpy(dest, src, length);
+		dest[length] = '\0';
+	}
+
+	// allows looking up std::string keys with string_view/const char* without a temporary
+	struct StringHash
+	{
+		using is_transparent = void;
+		std::size_t operator()(std::string_view str) const { return std::hash<std::string_view>{}(str); }
+	};
 }
 
 /**
@@ -0,0 +1,140 @@
+#include "CommandQueue.h"
+#include "Utils.h"
+
+namespace
+{
+	// commands that overwrite each other's effect, the later one is all that matters
+	bool sameTarget(const CommandQueue::Command& a, const CommandQueue::Command& b)
+	{
+		using Type = CommandQueue::Type;
+
+		switch (a.type)
+		{
+		case Type::ToggleEffect:
+			return b.type == Type::ToggleEffect && a.effect == b.effect;
+		case Type::ToggleReShade:
+			return b.type == Type::ToggleReShade;
+		case Type::SetUniform:
+		case Type::RestoreUniform:
+			return (b.type == Type::SetUniform || b.type == Type::RestoreUniform) && a.effect == b.effect && std::strcmp(a.uniform, b.uniform) == 0;
+		case Type::PrewarmEffect: // never dropped, the prewarmer requests an effect only once until the runtimes reload
+			return b.type == Type::PrewarmEffect && a.effect == b.effect;
+		default:
+			return false;
+		}
+	}
+}
+
+void CommandQueue::push(const Command& command)
+{
+	// once a target has spilled, later commands for it must follow it into the overflow or they'd run first
+	if (m_overflowCount.load(std::memory_order_acquire) == 0 && m_queue.tryPush(command))
+		return;
+
+	pushOverflow(command);
+}
+
+void CommandQueue::pushOverflow(const Command& command)
+{
+	std::scoped_lock lock(m_overflowLock);
+
+	auto it = std::ranges::find_if(m_overflow, [&](const Command& overflowed) { return sameTarget(overflowed, command); });
+	if (it != m_overflow.end())
+	{
+		*it = command;
+		m_coalescedCommands.fetch_add(1, std::memory_order_relaxed);
+		return;
+	}
+
+	// the render thread may have drained in the meantime
+	if (m_queue.tryPush(command))
+		return;
+
+	if (!m_overflowWarned.test_and_set(std::memory_order_relaxed))
+	{
+		SKSE::log::warn("Command queue is full ({} commands), coalescing toggles until the next frame", s_capacity);
+	}
+
+	m_overflow.push_back(command);
+	m_overflowCount.store(static_cast<std::uint32_t>(m_overflow.size()), std::memory_order_release);
+}
+
+void CommandQueue::pushToggleEffect(EffectTable::ID effect, bool state, Journal::Source source, std::uint64_t ruleID)
+{
+	Command command;
+	command.type = Type::ToggleEffect;
+	command.source = source;
+	command.state = state;
+	command.ruleID = ruleID;
+	command.effect = effect;
+
+	push(command);
+}
+
+void CommandQueue::pushToggleReShade(bool state, Journal::Source source)
+{
+	Command command;
+	command.type = Type::ToggleReShade;
+	command.source = source;
+	command.state = state;
+
+	push(command);
+}
+
+template <typename T>
+void CommandQueue::pushSetUniform(EffectTable::ID effect, const char* uniform, const T* values, size_t count, Journal::Source source, std::uint64_t ruleID)
+{
+	Command command;
+	command.type = Type::SetUniform;
+	command.source = source;
+	command.ruleID = ruleID;
+	command.valueCount = static_cast<std::uint8_t>(std::min<size_t>(count, 4));
+	command.effect = effect;
+	Utils::copyName(command.uniform, uniform);
+
+	if constexpr (std::is_same_v<T, bool>)
+		command.valueType = Journal::ValueType::Bool;
+	else if constexpr (std::is_same_v<T, int>)
+		command.valueType = Journal::ValueType::Int;
+	else if constexpr (std::is_same_v<T, unsigned int>)
+		command.valueType = Journal::ValueType::UInt;
+	else if constexpr (std::is_same_v<T, float>)
+		command.valueType = Journal::ValueType::Float;
+
+	for (std::uint8_t i = 0; i < command.valueCount; i++)
+	{
+		if constexpr (std::is_same_v<T, bool>)
+			command.values[i] = values[i];
+		else
+			command.values[i] = std::bit_cast<std::uint32_t>(values[i]);
+	}
+
+	push(command);
+}
+
+void CommandQueue::pushRestoreUniform(EffectTable::ID effect, const char* uniform, std::uint32_t baseline, std::uint64_t ruleID)
+{
+	Command command;
+	command.type = Type::RestoreUniform;
+	command.source = Journal::Source::Restore;
+	command.ruleID = ruleID;
+	command.effect = effect;
+	command.baseline = baseline;
+	Utils::copyName(command.uniform, uniform);
+
+	push(command);
+}
+
+void CommandQueue::pushPrewarmEffect(EffectTable::ID effect)
+{
+	Command command;
+	command.type = Type::PrewarmEffect;
+	command.effect = effect;
+
+	push(command);
+}
+
+template void CommandQueue::pushSetUniform<bool>(EffectTable::ID, const char*, const bool*, size_t, Journal::Source, std::uint64_t);
+template void CommandQueue::pushSetUniform<int>(EffectTable::ID, const char*, const int*, size_t, Journal::Source, std::uint64_t);
+template void CommandQueue::pushSetUniform<unsigned int>(EffectTable::ID, const char*, const unsigned int*, size_t, Journal::Source, std::uint64_t);
+template void CommandQueue::pushSetUniform<float>(EffectTable::ID, const char*, const float*, size_t, Journal::Source, std::uint64_t);
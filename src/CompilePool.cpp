@@ -0,0 +1,90 @@
+#include "CompilePool.h"
+
+std::uint32_t CompilePool::getThreadCount() const
+{
+	if (m_threads > 0)
+		return m_threads;
+
+	return std::clamp(std::thread::hardware_concurrency(), 1u, s_maxThreads);
+}
+
+bool CompilePool::take(std::vector<Worker>& workers, std::uint32_t self, std::uint32_t& task, bool& stolen)
+{
+	{
+		Worker& own = workers[self];
+		std::scoped_lock lock(own.lock);
+		if (!own.tasks.empty())
+		{
+			task = own.tasks.back();
+			own.tasks.pop_back();
+			stolen = false;
+			return true;
+		}
+	}
+
+	const auto count = static_cast<std::uint32_t>(workers.size());
+	for (std::uint32_t i = 1; i < count; i++)
+	{
+		Worker& victim = workers[(self + i) % count];
+		std::scoped_lock lock(victim.lock);
+		if (!victim.tasks.empty())
+		{
+			task = victim.tasks.front();
+			victim.tasks.pop_front();
+			stolen = true;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void CompilePool::run(std::vector<Task>& tasks, std::uint32_t threads)
+{
+	if (tasks.empty())
+		return;
+
+	const auto taskCount = static_cast<std::uint32_t>(tasks.size());
+	const std::uint32_t workerCount = std::min(threads > 0 ? std::min(threads, s_maxThreads) : getThreadCount(), taskCount);
+
+	if (workerCount <= 1)
+	{
+		for (auto& task : tasks)
+		{
+			task();
+		}
+		return;
+	}
+
+	// contiguous ranges, neighbouring tasks usually belong to the same key
+	std::vector<Worker> workers(workerCount);
+	for (std::uint32_t i = 0; i < taskCount; i++)
+	{
+		workers[static_cast<std::uint64_t>(i) * workerCount / taskCount].tasks.push_back(i);
+	}
+
+	// nothing is added once the workers started, an empty round means everything is taken
+	const auto work = [&](std::uint32_t self) {
+		std::uint32_t task = 0;
+		bool stolen = false;
+		while (take(workers, self, task, stolen))
+		{
+			if (stolen)
+			{
+				m_stolenTasks.fetch_add(1, std::memory_order_relaxed);
+			}
+			tasks[task]();
+		}
+		};
+
+	{
+		std::vector<std::jthread> helpers;
+		helpers.reserve(workerCount - 1);
+		for (std::uint32_t i = 1; i < workerCount; i++)
+		{
+			helpers.emplace_back(work, i);
+		}
+
+		work(0);
+	} // joined here
+}
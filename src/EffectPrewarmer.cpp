@@ -0,0 +1,51 @@
+#include "EffectPrewarmer.h"
+#include "CommandQueue.h"
+
+void EffectPrewarmer::request(EffectTable::ID effect)
+{
+	if (!isEnabled() || effect == EffectTable::s_entireReShade || effect >= EffectTable::s_capacity)
+		return;
+
+	std::scoped_lock lock(m_lock);
+
+	if (m_requested.test(effect))
+		return;
+
+	m_requested.set(effect);
+	m_pending.push_back(effect);
+}
+
+void EffectPrewarmer::update()
+{
+	const auto now = std::chrono::steady_clock::now();
+
+	std::scoped_lock lock(m_lock);
+
+	if (m_pending.empty())
+		return;
+
+	// a paused game hides the stall, otherwise compiles are spread out
+	const auto ui = RE::UI::GetSingleton();
+	const bool paused = ui && ui->GameIsPaused();
+	if (!paused && now < m_nextSend)
+		return;
+
+	m_nextSend = now + getInterval();
+
+	CommandQueue::GetSingleton()->pushPrewarmEffect(m_pending.front());
+	m_pending.pop_front();
+	m_sentCount.fetch_add(1, std::memory_order_relaxed);
+}
+
+void EffectPrewarmer::reset()
+{
+	std::scoped_lock lock(m_lock);
+	m_requested.reset();
+	m_pending.clear();
+}
+
+size_t EffectPrewarmer::getPendingCount() const
+{
+	std::scoped_lock lock(m_lock);
+	return m_pending.size();
+}
@@ -0,0 +1,43 @@
+#include "EffectTable.h"
+
+EffectTable::ID EffectTable::intern(std::string_view name)
+{
+	{
+		std::shared_lock lock(m_lock);
+		if (const auto it = m_ids.find(name); it != m_ids.end())
+			return it->second;
+	}
+
+	std::unique_lock lock(m_lock);
+	if (const auto it = m_ids.find(name); it != m_ids.end())
+		return it->second;
+
+	const size_t count = m_count.load(std::memory_order_relaxed);
+	if (count >= s_capacity)
+	{
+		SKSE::log::error("Effect table is full, can't add {}!", name);
+		return s_invalidID;
+	}
+
+	const auto id = static_cast<ID>(count);
+	m_names[id] = name;
+	m_ids.emplace(m_names[id], id);
+	m_count.store(count + 1, std::memory_order_release);
+
+	return id;
+}
+
+EffectTable::ID EffectTable::find(std::string_view name) const
+{
+	std::shared_lock lock(m_lock);
+	const auto it = m_ids.find(name);
+	return it != m_ids.end() ? it->second : s_invalidID;
+}
+
+const char* EffectTable::getName(ID id) const
+{
+	if (id >= m_count.load(std::memory_order_acquire))
+		return "";
+
+	return m_names[id].c_str();
+}
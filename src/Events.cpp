@@ -1,12 +1,22 @@
 #include "Events.h"
 #include "Manager.h"
+#include "Profiler.h"
 
 RE::BSEventNotifyControl Event::ProcessEvent(const RE::MenuOpenCloseEvent* a_event, RE::BSTEventSource<RE::MenuOpenCloseEvent>* a_source)
 {
+	PROFILE_ZONE(Profiler::Zone::ProcessEvent);
+
 	if (!a_event || !a_source)
 		return RE::BSEventNotifyControl::kContinue;
 
-	Manager::GetSingleton()->toggleEffectMenu(a_event->menuName.c_str(), a_event->opening);
+	const auto manager = Manager::GetSingleton();
+	manager->toggleEffectMenu(a_event->menuName.c_str(), a_event->opening);
+	manager->toggleEffectRules(); // rules can depend on menus being open
+
+	if (!a_event->opening)
+	{
+		TickScheduler::GetSingleton()->wakeAll(); // passes sleep while the game is paused
+	}
 
 	return RE::BSEventNotifyControl::kContinue;
 }
\ No newline at end of file
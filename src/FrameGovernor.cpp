@@ -0,0 +1,74 @@
+#include "FrameGovernor.h"
+#include "Manager.h"
+
+void FrameGovernor::configure(const Config& config, std::vector<Candidate> candidates)
+{
+	std::vector<Candidate> restore;
+	{
+		std::scoped_lock lock(m_lock);
+		restore = m_policy.configure(config, std::move(candidates));
+	}
+
+	for (const auto& candidate : restore)
+	{
+		Manager::GetSingleton()->toggleEffect(candidate.effect, candidate.wanted, Journal::Source::Governor);
+	}
+}
+
+void FrameGovernor::onPresent()
+{
+	const auto now = std::chrono::steady_clock::now();
+	const auto last = std::exchange(m_lastPresent, now);
+	if (last == std::chrono::steady_clock::time_point{})
+		return;
+
+	const float frameMs = std::chrono::duration<float, std::milli>(now - last).count();
+
+	GovernorPolicy::Decision decision;
+	{
+		std::scoped_lock lock(m_lock);
+		decision = m_policy.onFrame(frameMs, [](EffectTable::ID effect) {
+			bool enabled = false;
+			RuntimeRegistry::GetSingleton()->forEach([&](RuntimeRegistry::Entry& entry) {
+				const auto& techniques = entry.getTechniques(effect);
+				enabled |= !techniques.empty() && entry.runtime->get_technique_state(techniques.front());
+				});
+			return enabled;
+			});
+		m_percentileMs.store(m_policy.getPercentileMs(), std::memory_order_relaxed);
+	}
+
+	if (decision.action != Action::None)
+	{
+		SKSE::log::debug("Frame governor {} {} at a frame time of {:.2f} ms", decision.action == Action::Shed ? "shed" : "restored",
+			EffectTable::GetSingleton()->getName(decision.effect), getPercentileMs());
+		Manager::GetSingleton()->toggleEffect(decision.effect, decision.state, Journal::Source::Governor);
+	}
+}
+
+void FrameGovernor::observe(const CommandQueue::Command& command)
+{
+	if (command.type != CommandQueue::Type::ToggleEffect || command.source == Journal::Source::Governor || command.effect >= EffectTable::s_capacity)
+		return;
+
+	std::scoped_lock lock(m_lock);
+	m_policy.observe(command.effect, command.state);
+}
+
+bool FrameGovernor::isShed(EffectTable::ID effect) const
+{
+	std::scoped_lock lock(m_lock);
+	return m_policy.isShed(effect);
+}
+
+FrameGovernor::Config FrameGovernor::getConfig() const
+{
+	std::scoped_lock lock(m_lock);
+	return m_policy.getConfig();
+}
+
+std::vector<FrameGovernor::Candidate> FrameGovernor::getCandidates() const
+{
+	std::scoped_lock lock(m_lock);
+	return m_policy.getCandidates();
+}
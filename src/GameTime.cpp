@@ -0,0 +1,129 @@
+#include "GameTime.h"
+
+namespace GameTime
+{
+	std::uint16_t fromLegacyTime(float time)
+	{
+		const int hours = static_cast<int>(time);
+		const int minutes = static_cast<int>(std::lround((time - hours) * 100.f));
+		return toMinuteOfDay(hours, minutes);
+	}
+
+	MinuteMask buildMask(const std::vector<Window>& windows)
+	{
+		MinuteMask mask{};
+
+		const auto setRange = [&mask](std::uint16_t first, std::uint16_t last) {
+			for (std::uint16_t minute = first; minute <= last; minute++)
+			{
+				mask[minute >> 6] |= 1ull << (minute & 63);
+			}
+			};
+
+		for (const auto& window : windows)
+		{
+			const std::uint16_t start = std::min<std::uint16_t>(window.start, kMinutesPerDay - 1);
+			const std::uint16_t stop = std::min<std::uint16_t>(window.stop, kMinutesPerDay - 1);
+
+			if (start <= stop)
+			{
+				setRange(start, stop);
+			}
+			else
+			{
+				setRange(start, kMinutesPerDay - 1);
+				setRange(0, stop);
+			}
+		}
+
+		return mask;
+	}
+
+	std::uint16_t findNext(const MinuteMask& mask, std::uint16_t minute)
+	{
+		const auto search = [&mask](std::uint16_t from) -> std::uint16_t {
+			for (size_t word = from >> 6; word < mask.size(); word++)
+			{
+				std::uint64_t bits = mask[word];
+				if (word == static_cast<size_t>(from >> 6))
+				{
+					bits &= ~0ull << (from & 63);
+				}
+
+				if (bits)
+					return static_cast<std::uint16_t>(word * 64 + std::countr_zero(bits));
+			}
+			return kMinutesPerDay;
+			};
+
+		const std::uint16_t next = search(static_cast<std::uint16_t>((minute + 1) % kMinutesPerDay));
+		return next != kMinutesPerDay ? next : search(0);
+	}
+
+	float getMinutesUntil(std::uint16_t minute)
+	{
+		const float now = RE::Calendar::GetSingleton()->GetHour() * 60.f;
+
+		float minutes = static_cast<float>(minute) - now;
+		if (minutes <= 0.f)
+		{
+			minutes += kMinutesPerDay;
+		}
+		return minutes;
+	}
+
+	std::uint16_t getCurrentMinute()
+	{
+		const auto calendar = RE::Calendar::GetSingleton();
+		return toMinuteOfDay(static_cast<int>(calendar->GetHour()), static_cast<int>(calendar->GetMinutes()));
+	}
+
+	std::uint32_t buildDateMask(const std::vector<std::string>& days, const std::vector<std::string>& months, const std::vector<std::string>& seasons)
+	{
+		const auto indexOf = [](const std::vector<std::string>& options, const std::string& name) {
+			const auto it = std::find(options.begin(), options.end(), name);
+			return it != options.end() ? static_cast<std::uint32_t>(it - options.begin()) : UINT32_MAX;
+			};
+
+		std::uint32_t dayMask = 0;
+		for (const auto& day : days)
+		{
+			if (const auto index = indexOf(s_dayOptions, day); index != UINT32_MAX)
+				dayMask |= 1u << (kWeekday + index);
+		}
+
+		std::uint32_t monthMask = 0;
+		for (const auto& month : months)
+		{
+			if (const auto index = indexOf(s_monthOptions, month); index != UINT32_MAX)
+				monthMask |= 1u << (kMonth + index);
+		}
+
+		// three months each, winter wraps around the new year
+		for (const auto& season : seasons)
+		{
+			if (const auto index = indexOf(s_seasonOptions, season); index != UINT32_MAX)
+			{
+				for (std::uint32_t month = index * 3 + 2; month < index * 3 + 5; month++)
+				{
+					monthMask |= 1u << (kMonth + month % 12);
+				}
+			}
+		}
+
+		return (dayMask ? dayMask : kWeekdayBits) | (monthMask ? monthMask : kMonthBits);
+	}
+
+	std::uint32_t getCurrentDate()
+	{
+		const auto calendar = RE::Calendar::GetSingleton();
+		const std::uint32_t weekday = std::min<std::uint32_t>(calendar->GetDayOfWeek(), 6);
+		const std::uint32_t month = std::min<std::uint32_t>(calendar->GetMonth(), 11);
+		return (1u << (kWeekday + weekday)) | (1u << (kMonth + month));
+	}
+
+	std::uint32_t getCurrentDay()
+	{
+		return static_cast<std::uint32_t>(RE::Calendar::GetSingleton()->GetDaysPassed());
+	}
+}
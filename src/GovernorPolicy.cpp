@@ -0,0 +1,104 @@
+#include "GovernorPolicy.h"
+
+std::vector<GovernorPolicy::Candidate> GovernorPolicy::configure(const Config& config, std::vector<Candidate> candidates)
+{
+	std::vector<Candidate> restore;
+	for (const size_t index : m_shedOrder)
+	{
+		restore.push_back(m_candidates[index]);
+	}
+
+	std::stable_sort(candidates.begin(), candidates.end(), [](const Candidate& a, const Candidate& b) { return a.priority < b.priority; });
+
+	m_config = config;
+	m_config.percentile = std::clamp(m_config.percentile, 0.f, 1.f);
+	m_config.settleFrames = std::max(m_config.settleFrames, s_evaluateInterval);
+	m_candidates = std::move(candidates);
+	m_shedOrder.clear();
+	m_shed.reset();
+	m_frameCount = 0;
+	m_framesSinceAction = 0;
+	m_measuring = SIZE_MAX;
+
+	return restore;
+}
+
+GovernorPolicy::Decision GovernorPolicy::onFrame(float frameMs, const std::function<bool(EffectID)>& isEnabled)
+{
+	if (!m_config.enabled || frameMs > s_maxFrameMs)
+		return {};
+
+	m_frameTimes[m_nextFrame] = frameMs;
+	m_nextFrame = (m_nextFrame + 1) % s_windowSize;
+	m_frameCount = std::min(m_frameCount + 1, s_windowSize);
+	m_framesSinceAction++;
+
+	if (m_frameCount < s_windowSize || m_framesSinceAction < m_config.settleFrames || m_framesSinceAction % s_evaluateInterval != 0)
+		return {};
+
+	const float percentile = computePercentile();
+	m_percentileMs = percentile;
+
+	if (m_measuring != SIZE_MAX)
+	{
+		m_candidates[m_measuring].measuredCostMs = std::max(m_percentileBeforeShed - percentile, 0.f);
+		m_measuring = SIZE_MAX;
+	}
+
+	if (percentile > m_config.targetMs)
+	{
+		for (size_t i = 0; i < m_candidates.size(); i++)
+		{
+			auto& candidate = m_candidates[i];
+			if (candidate.shed || !isEnabled(candidate.effect))
+				continue;
+
+			candidate.shed = true;
+			candidate.wanted = true;
+			m_shed.set(candidate.effect);
+			m_shedOrder.push_back(i);
+
+			m_measuring = i;
+			m_percentileBeforeShed = percentile;
+			m_framesSinceAction = 0;
+			return { Action::Shed, candidate.effect, false };
+		}
+
+		return {}; // nothing left to shed
+	}
+
+	if (m_shedOrder.empty())
+		return {};
+
+	auto& candidate = m_candidates[m_shedOrder.back()];
+	if (candidate.wanted && percentile + candidate.measuredCostMs > m_config.targetMs * m_config.restoreRatio)
+		return {};
+
+	candidate.shed = false;
+	m_shed.reset(candidate.effect);
+	m_shedOrder.pop_back();
+	m_framesSinceAction = 0;
+	return { Action::Restore, candidate.effect, candidate.wanted };
+}
+
+void GovernorPolicy::observe(EffectID effect, bool state)
+{
+	if (!isShed(effect))
+		return;
+
+	for (auto& candidate : m_candidates)
+	{
+		if (candidate.effect == effect)
+		{
+			candidate.wanted = state;
+		}
+	}
+}
+
+float GovernorPolicy::computePercentile() const
+{
+	std::array<float, s_windowSize> sorted = m_frameTimes;
+	const auto index = static_cast<size_t>(m_config.percentile * (s_windowSize - 1));
+	std::nth_element(sorted.begin(), sorted.begin() + index, sorted.end());
+	return sorted[index];
+}
@@ -1,5 +1,8 @@
 #include "Hooks.h"
 #include "Manager.h"
+#include "Profiler.h"
+#include "EffectPrewarmer.h"
+#include "ToggleDebouncer.h"
 
 namespace Hook
 {
@@ -10,16 +13,43 @@ namespace Hook
 		{
 			func(); // Run original function
 
-			static auto lastCallTime = std::chrono::steady_clock::now();
-			auto now = std::chrono::steady_clock::now();
+			PROFILE_ZONE(Profiler::Zone::MainUpdate);
 
-			if (std::chrono::duration_cast<std::chrono::milliseconds>(now - lastCallTime).count() >= 500)
-			{
-				lastCallTime = now;
+			Manager::GetSingleton()->evaluatePresetSwitch();
+
+			UniformAnimator::GetSingleton()->update();
+			UniformTransitions::GetSingleton()->update();
+			UniformBindings::GetSingleton()->update();
+			EffectPrewarmer::GetSingleton()->update();
+			ToggleDebouncer::GetSingleton()->update();
+
+			const auto scheduler = TickScheduler::GetSingleton();
+			const auto now = TickScheduler::Clock::now();
 
+			if (scheduler->anyDue(now))
+			{
+				using Pass = TickScheduler::Pass;
 				const auto singleton = Manager::GetSingleton();
-				singleton->toggleEffectWeather();
-				singleton->toggleEffectTime();
+
+				// rescheduled before running, so a wake from another thread during the pass isn't lost
+				if (scheduler->isDue(Pass::Weather, now))
+				{
+					scheduler->schedule(Pass::Weather, now, singleton->getNextWeatherChange());
+					singleton->toggleEffectWeather();
+				}
+
+				if (scheduler->isDue(Pass::Time, now))
+				{
+					scheduler->schedule(Pass::Time, now, singleton->getNextTimeChange());
+					singleton->toggleEffectTime();
+					singleton->prewarmUpcomingEffects();
+				}
+
+				if (scheduler->isDue(Pass::Rules, now))
+				{
+					scheduler->schedule(Pass::Rules, now, singleton->getNextRulesChange());
+					singleton->toggleEffectRules();
+				}
 			}
 
 		};
@@ -40,7 +70,10 @@ namespace Hook
 		{
 			func(a_playerIsInInterior);
 
-			Manager::GetSingleton()->toggleEffectInterior(a_playerIsInInterior);
+			const auto manager = Manager::GetSingleton();
+			manager->toggleEffectInterior(a_playerIsInInterior);
+			manager->prewarmUpcomingEffects();
+			TickScheduler::GetSingleton()->wakeAll(); // the worldspace may have changed as well
 
 		};
 		static inline REL::Relocation<decltype(thunk)> func;
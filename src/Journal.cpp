@@ -0,0 +1,324 @@
+#include "Journal.h"
+#include "Utils.h"
+
+namespace
+{
+	std::uint64_t nowMicroseconds()
+	{
+		return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now().time_since_epoch()).count());
+	}
+
+	template <typename T>
+	constexpr Journal::ValueType getValueType()
+	{
+		if constexpr (std::is_same_v<T, bool>)
+			return Journal::ValueType::Bool;
+		else if constexpr (std::is_same_v<T, int>)
+			return Journal::ValueType::Int;
+		else if constexpr (std::is_same_v<T, unsigned int>)
+			return Journal::ValueType::UInt;
+		else if constexpr (std::is_same_v<T, float>)
+			return Journal::ValueType::Float;
+		else
+			return Journal::ValueType::None;
+	}
+
+	// names come from effect files and presets, so they may contain anything
+	std::string quoteField(std::string_view field)
+	{
+		if (field.find_first_of(",\"\r\n") == std::string_view::npos)
+			return std::string(field);
+
+		std::string result = "\"";
+		for (const char c : field)
+		{
+			if (c == '"')
+				result += '"';
+			result += c;
+		}
+		result += '"';
+		return result;
+	}
+
+	std::string formatValues(Journal::ValueType type, const std::uint32_t* values, std::uint8_t count)
+	{
+		std::string result;
+		for (std::uint8_t i = 0; i < count; i++)
+		{
+			if (i > 0)
+				result += ' ';
+
+			switch (type)
+			{
+			case Journal::ValueType::Bool:
+				result += values[i] ? "true" : "false";
+				break;
+			case Journal::ValueType::Int:
+				result += std::to_string(static_cast<std::int32_t>(values[i]));
+				break;
+			case Journal::ValueType::UInt:
+				result += std::to_string(values[i]);
+				break;
+			case Journal::ValueType::Float:
+				result += std::to_string(std::bit_cast<float>(values[i]));
+				break;
+			default:
+				break;
+			}
+		}
+		return result;
+	}
+}
+
+const char* Journal::getSourceName(Source source)
+{
+	switch (source)
+	{
+	case Source::Menu: return "Menu";
+	case Source::Weather: return "Weather";
+	case Source::Time: return "Time";
+	case Source::Interior: return "Interior";
+	case Source::Papyrus: return "Papyrus";
+	case Source::UI: return "UI";
+	case Source::Rule: return "Rule";
+	case Source::Restore: return "Restore";
+	case Source::Governor: return "Governor";
+	default: return "Unknown";
+	}
+}
+
+std::filesystem::path Journal::getLogPath() const
+{
+	auto directory = SKSE::log::log_directory();
+	if (!directory)
+	{
+		return std::filesystem::path("Data\\SKSE\\Plugins") / std::format("{}.journal", Plugin::NAME);
+	}
+
+	return *directory / std::format("{}.journal", Plugin::NAME);
+}
+
+void Journal::start()
+{
+	if (m_writer.joinable())
+		return;
+
+	if (!m_queue)
+	{
+		m_queue = std::make_unique<Queue>();
+	}
+
+	m_enabled.store(true, std::memory_order_release);
+	m_writer = std::jthread([this](std::stop_token stopToken) { writerLoop(stopToken); });
+}
+
+void Journal::stop()
+{
+	m_enabled.store(false, std::memory_order_release);
+
+	if (m_writer.joinable())
+	{
+		m_writer.request_stop();
+		m_writer.join();
+	}
+}
+
+void Journal::push(const Record& record)
+{
+	// full, the writer fell behind; a diagnostic log may lose records, toggles never depend on it
+	if (!m_queue->tryPush(record))
+	{
+		m_droppedRecords.fetch_add(1, std::memory_order_relaxed);
+	}
+}
+
+void Journal::recordTechnique(Source source, std::uint64_t ruleID, const char* effect, bool oldState, bool newState)
+{
+	if (!isEnabled())
+		return;
+
+	Record record;
+	record.timestamp = nowMicroseconds();
+	record.ruleID = ruleID;
+	record.kind = Kind::Technique;
+	record.source = source;
+	record.oldState = oldState;
+	record.newState = newState;
+	Utils::copyName(record.effect, effect);
+
+	push(record);
+}
+
+void Journal::recordEffectsState(Source source, bool oldState, bool newState)
+{
+	if (!isEnabled())
+		return;
+
+	Record record;
+	record.timestamp = nowMicroseconds();
+	record.kind = Kind::EffectsState;
+	record.source = source;
+	record.oldState = oldState;
+	record.newState = newState;
+	Utils::copyName(record.effect, "EntireReShade");
+
+	push(record);
+}
+
+template <typename T>
+void Journal::recordUniform(Source source, std::uint64_t ruleID, const char* effect, const char* uniform, const T* oldValues, const T* newValues, size_t count)
+{
+	if (!isEnabled())
+		return;
+
+	Record record;
+	record.timestamp = nowMicroseconds();
+	record.ruleID = ruleID;
+	record.kind = Kind::Uniform;
+	record.source = source;
+	record.valueType = getValueType<T>();
+	record.valueCount = static_cast<std::uint8_t>(std::min<size_t>(count, 4));
+	Utils::copyName(record.effect, effect);
+	Utils::copyName(record.uniform, uniform);
+
+	record.oldKnown = oldValues != nullptr;
+
+	for (std::uint8_t i = 0; i < record.valueCount; i++)
+	{
+		if constexpr (std::is_same_v<T, bool>)
+		{
+			record.oldValues[i] = oldValues ? oldValues[i] : false;
+			record.newValues[i] = newValues[i];
+		}
+		else
+		{
+			record.oldValues[i] = oldValues ? std::bit_cast<std::uint32_t>(oldValues[i]) : 0;
+			record.newValues[i] = std::bit_cast<std::uint32_t>(newValues[i]);
+		}
+	}
+
+	push(record);
+}
+
+template void Journal::recordUniform<bool>(Source, std::uint64_t, const char*, const char*, const bool*, const bool*, size_t);
+template void Journal::recordUniform<int>(Source, std::uint64_t, const char*, const char*, const int*, const int*, size_t);
+template void Journal::recordUniform<unsigned int>(Source, std::uint64_t, const char*, const char*, const unsigned int*, const unsigned int*, size_t);
+template void Journal::recordUniform<float>(Source, std::uint64_t, const char*, const char*, const float*, const float*, size_t);
+
+void Journal::writerLoop(std::stop_token stopToken)
+{
+	const auto path = getLogPath();
+
+	const std::uint32_t header[3] = { s_magic, s_version, static_cast<std::uint32_t>(sizeof(Record)) };
+
+	// restarting the journal within a session keeps what was captured so far
+	bool append = false;
+	if (m_fileStarted)
+	{
+		std::uint32_t existing[3] = {};
+		std::ifstream in(path, std::ios::binary);
+		append = in.read(reinterpret_cast<char*>(existing), sizeof(existing)) && std::memcmp(existing, header, sizeof(header)) == 0;
+	}
+
+	std::ofstream file(path, std::ios::binary | (append ? std::ios::app : std::ios::trunc));
+	if (!file.is_open())
+	{
+		SKSE::log::error("Couldn't open toggle journal {}!", path.string());
+		m_enabled.store(false, std::memory_order_release);
+		return;
+	}
+	m_fileStarted = true;
+
+	if (!append)
+	{
+		file.write(reinterpret_cast<const char*>(header), sizeof(header));
+	}
+
+	std::vector<Record> batch;
+	batch.reserve(256);
+
+	auto drain = [&]() {
+		Record record;
+		while (m_queue->tryPop(record))
+		{
+			batch.emplace_back(record);
+			if (batch.size() == batch.capacity())
+			{
+				file.write(reinterpret_cast<const char*>(batch.data()), batch.size() * sizeof(Record));
+				m_writtenRecords.fetch_add(batch.size(), std::memory_order_relaxed);
+				batch.clear();
+			}
+		}
+
+		if (!batch.empty())
+		{
+			file.write(reinterpret_cast<const char*>(batch.data()), batch.size() * sizeof(Record));
+			m_writtenRecords.fetch_add(batch.size(), std::memory_order_relaxed);
+			batch.clear();
+		}
+		file.flush();
+		};
+
+	while (!stopToken.stop_requested())
+	{
+		drain();
+
+		// returns early once stop is requested
+		std::unique_lock lock(m_wakeLock);
+		m_wake.wait_for(lock, stopToken, 200ms, []() { return false; });
+	}
+
+	drain();
+}
+
+bool Journal::decodeToCSV(const std::filesystem::path& logPath, const std::filesystem::path& csvPath)
+{
+	std::ifstream in(logPath, std::ios::binary);
+	if (!in.is_open())
+	{
+		SKSE::log::error("Couldn't open toggle journal {}!", logPath.string());
+		return false;
+	}
+
+	std::uint32_t header[3] = {};
+	in.read(reinterpret_cast<char*>(header), sizeof(header));
+	if (!in || header[0] != s_magic || header[1] != s_version || header[2] != sizeof(Record))
+	{
+		SKSE::log::error("Toggle journal {} has an unknown format!", logPath.string());
+		return false;
+	}
+
+	std::ofstream out(csvPath, std::ios::trunc);
+	if (!out.is_open())
+	{
+		SKSE::log::error("Couldn't write {}!", csvPath.string());
+		return false;
+	}
+
+	out << "timestamp_us,source,rule_id,kind,effect,uniform,old,new\n";
+
+	Record record;
+	while (in.read(reinterpret_cast<char*>(&record), sizeof(Record)))
+	{
+		record.effect[sizeof(record.effect) - 1] = '\0';
+		record.uniform[sizeof(record.uniform) - 1] = '\0';
+
+		out << record.timestamp << ',' << getSourceName(record.source) << ',' << record.ruleID << ',';
+
+		switch (record.kind)
+		{
+		case Kind::Technique:
+		case Kind::EffectsState:
+			out << (record.kind == Kind::Technique ? "Technique" : "EffectsState") << ',' << quoteField(record.effect) << ",,"
+				<< (record.oldState ? "on" : "off") << ',' << (record.newState ? "on" : "off") << '\n';
+			break;
+		case Kind::Uniform:
+			out << "Uniform," << quoteField(record.effect) << ',' << quoteField(record.uniform) << ','
+				<< (record.oldKnown ? formatValues(record.valueType, record.oldValues, record.valueCount) : "") << ','
+				<< formatValues(record.valueType, record.newValues, record.valueCount) << '\n';
+			break;
+		}
+	}
+
+	return true;
+}
@@ -0,0 +1,166 @@
+#include "Logging.h"
+#include "Utils.h"
+
+#include <spdlog/async.h>
+#include <spdlog/sinks/dist_sink.h>
+
+namespace Logging
+{
+	// Drops repeats of a message within the window even when other messages come in between, e.g. one
+	// warning per rule and frame. The next copy after the window notes how many were skipped.
+	template <typename Mutex>
+	class RateLimitSink : public spdlog::sinks::dist_sink<Mutex>
+	{
+	public:
+		explicit RateLimitSink(std::chrono::seconds window) :
+			m_window(window) {}
+
+	protected:
+		void sink_it_(const spdlog::details::log_msg& msg) override
+		{
+			if (m_window.count() == 0)
+			{
+				spdlog::sinks::dist_sink<Mutex>::sink_it_(msg);
+				return;
+			}
+
+			const std::string_view payload(msg.payload.data(), msg.payload.size());
+			const std::size_t key = std::hash<std::string_view>{}(payload) ^ static_cast<std::size_t>(msg.level);
+
+			auto& entry = m_entries[key];
+			if (entry.seen && msg.time - entry.last < m_window)
+			{
+				entry.skipped++;
+				return;
+			}
+
+			if (entry.skipped > 0)
+			{
+				const auto notice = std::format("Skipped {} repeats of the next message", entry.skipped);
+				const spdlog::details::log_msg skipped(msg.logger_name, spdlog::level::info, notice);
+				spdlog::sinks::dist_sink<Mutex>::sink_it_(skipped);
+			}
+
+			entry = { msg.time, 0, true };
+			prune(msg.time);
+
+			spdlog::sinks::dist_sink<Mutex>::sink_it_(msg);
+		}
+
+	private:
+		static constexpr std::size_t s_maxKeys = 1024;
+
+		struct Entry
+		{
+			spdlog::log_clock::time_point last{};
+			std::uint32_t skipped = 0;
+			bool seen = false;
+		};
+
+		// keys outside the window carry nothing but a skipped count nobody will see
+		void prune(spdlog::log_clock::time_point now)
+		{
+			if (m_entries.size() <= s_maxKeys)
+				return;
+
+			std::erase_if(m_entries, [&](const auto& pair) { return now - pair.second.last >= m_window; });
+		}
+
+		std::chrono::seconds m_window;
+		std::unordered_map<std::size_t, Entry> m_entries;
+	};
+
+	struct Settings
+	{
+#ifndef NDEBUG
+		std::string level = "trace";
+		bool async = false;
+#else
+		std::string level = "info";
+		bool async = true;
+#endif
+		int queueSize = 8192;
+		int flushIntervalSeconds = 3;
+		int rateLimitSeconds = 5;
+	};
+
+	static Settings LoadSettings()
+	{
+		const auto path = std::format("Data/SKSE/Plugins/{}.ini", Plugin::NAME);
+
+		CSimpleIniA ini;
+		ini.SetUnicode();
+		ini.LoadFile(path.c_str());
+
+		Settings settings;
+		Utils::loadINIStringSetting(ini, "Logging", "Level", settings.level);
+		Utils::loadINIBoolSetting(ini, "Logging", "Async", settings.async);
+		Utils::loadINIIntSetting(ini, "Logging", "QueueSize", settings.queueSize);
+		Utils::loadINIIntSetting(ini, "Logging", "FlushIntervalSeconds", settings.flushIntervalSeconds);
+		Utils::loadINIIntSetting(ini, "Logging", "RateLimitSeconds", settings.rateLimitSeconds);
+
+		settings.queueSize = std::clamp(settings.queueSize, 128, 1 << 20);
+		settings.flushIntervalSeconds = std::max(settings.flushIntervalSeconds, 1);
+		settings.rateLimitSeconds = std::max(settings.rateLimitSeconds, 0);
+
+		return settings;
+	}
+
+	void Init()
+	{
+		const Settings settings = LoadSettings();
+
+		auto path = SKSE::log::log_directory();
+		if (!path)
+		{
+			SKSE::stl::report_and_fail("Failed to find standard logging directory"sv);
+		}
+		*path /= std::format("{}.log", Plugin::NAME);
+
+		auto fileSink = std::make_shared<spdlog::sinks::basic_file_sink_mt>(path->string(), true);
+
+		// collapses repeated lines (e.g. one error per rule) into a single "skipped" notice
+		auto sink = std::make_shared<RateLimitSink<std::mutex>>(std::chrono::seconds(settings.rateLimitSeconds));
+		sink->add_sink(fileSink);
+
+		std::shared_ptr<spdlog::logger> log;
+		if (settings.async)
+		{
+			spdlog::init_thread_pool(static_cast<std::size_t>(settings.queueSize), 1);
+			// overrun_oldest drops old messages instead of blocking the calling thread when the queue is full
+			log = std::make_shared<spdlog::async_logger>("global", sink, spdlog::thread_pool(), spdlog::async_overflow_policy::overrun_oldest);
+		}
+		else
+		{
+			log = std::make_shared<spdlog::logger>("global", sink);
+		}
+
+		// from_str maps anything it doesn't know to off
+		const std::string levelName = Utils::tolower(settings.level);
+		auto level = spdlog::level::from_str(levelName);
+		const bool unknownLevel = level == spdlog::level::off && levelName != "off";
+		if (unknownLevel)
+		{
+			level = spdlog::level::info;
+		}
+		log->set_level(level);
+
+		spdlog::set_default_logger(std::move(log));
+		spdlog::set_pattern("[%H:%M:%S:%e] [%l] %v"s);
+
+		if (unknownLevel)
+		{
+			SKSE::log::warn("Unknown log level \"{}\" in [Logging], using info", settings.level);
+		}
+
+		if (settings.async)
+		{
+			spdlog::flush_on(spdlog::level::err);
+			spdlog::flush_every(std::chrono::seconds(settings.flushIntervalSeconds));
+		}
+		else
+		{
+			spdlog::flush_on(level);
+		}
+	}
+}
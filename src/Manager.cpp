@@ -1,9 +1,67 @@
 #include "Manager.h"
 #include "Utils.h"
+#include "Profiler.h"
+#include "StateSnapshot.h"
+#include "FrameGovernor.h"
+#include "EffectPrewarmer.h"
+#include "CompilePool.h"
 #include "glaze/glaze.hpp"
+#include <random>
+
+namespace
+{
+	// keyed by worldspace, a rule holds while its weather is the current one
+	struct WeatherSource
+	{
+		using Info = WeatherToggleInformation;
+		static constexpr Journal::Source s_source = Journal::Source::Weather;
+		static constexpr bool s_tracksToggled = true;
+
+		struct Context
+		{
+			RE::TESForm* form = nullptr; // null in interiors
+			std::string weather;
+		};
+
+		static bool isWanted(const Info& info, const Context& context) { return info.weather == context.weather; }
+	};
+
+	// keyed by worldspace or cell, a rule holds within its time windows on the days it applies to
+	struct TimeSource
+	{
+		using Info = TimeToggleInformation;
+		static constexpr Journal::Source s_source = Journal::Source::Time;
+		static constexpr bool s_tracksToggled = true;
+
+		struct Context
+		{
+			RE::TESForm* form = nullptr;
+			std::uint16_t minute = 0;
+		};
+
+		static bool isWanted(const Info& info, const Context& context) { return info.activeToday && GameTime::contains(info.minuteMask, context.minute); }
+	};
+
+	// keyed by interior cell, every rule holds for as long as the player is in the cell
+	struct InteriorSource
+	{
+		using Info = InteriorToggleInformation;
+		static constexpr Journal::Source s_source = Journal::Source::Interior;
+		static constexpr bool s_tracksToggled = false;
+
+		struct Context
+		{
+			RE::TESForm* form = nullptr; // null outside of interiors
+		};
+
+		static bool isWanted(const Info&, const Context&) { return true; }
+	};
+}
 
 bool Manager::parseJSONPreset(const std::string& presetName)
 {
+	PROFILE_ZONE(Profiler::Zone::ParsePreset);
+
 	const std::string fullPath = getPresetPath(presetName);
 
 	std::ifstream openFile(fullPath);
@@ -20,12 +78,39 @@ bool Manager::parseJSONPreset(const std::string& presetName)
 	const auto timePair = std::make_pair("Time", std::ref(m_timeToggleInfo));
 	const auto weatherPair = std::make_pair("Weather", std::ref(m_weatherToggleInfo));
 	const auto interiorPair = std::make_pair("Interior", std::ref(m_interiorToggleInfo));
+	const auto rulePair = std::make_pair("Rules", std::ref(m_ruleToggleInfo));
+
+	std::scoped_lock lock(m_dataLock);
+	m_presetSwitch.store(PresetSwitch::Evaluating, std::memory_order_release);
+	releaseToggleCaches();
+	ToggleDebouncer::GetSingleton()->clear();
+	UniformAnimator::GetSingleton()->clear();
+	UniformBindings::GetSingleton()->clear();
+	const bool success = deserializeArbitraryData(buffer.str(), menuPair, timePair, weatherPair, interiorPair, rulePair);
+
+	compilePreset({ m_menuToggleInfo, m_timeToggleInfo, m_weatherToggleInfo, m_interiorToggleInfo, m_ruleToggleInfo }, m_timeBoundaries, m_ruleStore);
+	m_timeRuleDatesDirty = true;
+	m_fingerprints[static_cast<std::size_t>(TickScheduler::Pass::Time)].invalidate();
+	m_ruleResults.assign(m_ruleStore.resultWords(), 0);
+	m_rulesDirty = false;
+
+	// in order, so the same preset always gets the same IDs
+	m_lastRuleID = 0;
+	assignRuleIDs(m_menuToggleInfo, true);
+	assignRuleIDs(m_timeToggleInfo, true);
+	assignRuleIDs(m_weatherToggleInfo, true);
+	assignRuleIDs(m_interiorToggleInfo, true);
+	assignRuleIDs(m_ruleToggleInfo, true);
+
+	TickScheduler::GetSingleton()->wakeAll();
 
-	return deserializeArbitraryData(buffer.str(), menuPair, timePair, weatherPair, interiorPair);
+	return success;
 }
 
 bool Manager::serializeJSONPreset(const std::string& presetName)
 {
+	PROFILE_ZONE(Profiler::Zone::SerializePreset);
+
 	const std::string fullPath = getPresetPath(presetName);
 
 	std::ofstream outFile(fullPath);
@@ -36,16 +121,19 @@ bool Manager::serializeJSONPreset(const std::string& presetName)
 	}
 
 	std::string buffer;
+	std::unique_lock lock(m_dataLock);
 	if (!serializeArbitraryData(buffer,
 		std::make_pair("Menu", m_menuToggleInfo),
 		std::make_pair("Time", m_timeToggleInfo),
 		std::make_pair("Weather", m_weatherToggleInfo),
-		std::make_pair("Interior", m_interiorToggleInfo)
+		std::make_pair("Interior", m_interiorToggleInfo),
+		std::make_pair("Rules", m_ruleToggleInfo)
 		))
 	{
 		SKSE::log::error("Failed to serialize preset {}!", presetName);
 		return false;
 	}
+	lock.unlock();
 
 	// TODO: prettify
 	outFile << buffer;
@@ -63,6 +151,64 @@ void Manager::parseINI()
 	ini.LoadFile(path.c_str());
 
 	Utils::loadINIStringSetting(ini, "Preset", "LastPreset", m_lastPresetName);
+	Utils::loadINIBoolSetting(ini, "Journal", "Enabled", m_journalEnabled);
+
+	float epsilon = UniformAnimator::GetSingleton()->getEpsilon();
+	Utils::loadINIFloatSetting(ini, "Animation", "Epsilon", epsilon);
+	UniformAnimator::GetSingleton()->setEpsilon(epsilon);
+
+	const auto transitions = UniformTransitions::GetSingleton();
+	float duration = transitions->getDuration();
+	bool followWeather = transitions->isFollowingWeather();
+	Utils::loadINIFloatSetting(ini, "Transitions", "DurationSeconds", duration);
+	Utils::loadINIBoolSetting(ini, "Transitions", "FollowWeather", followWeather);
+	transitions->setDuration(duration);
+	transitions->setFollowingWeather(followWeather);
+
+	const auto scheduler = TickScheduler::GetSingleton();
+	int minInterval = static_cast<int>(scheduler->getMinInterval().count());
+	int maxInterval = static_cast<int>(scheduler->getMaxInterval().count());
+	Utils::loadINIIntSetting(ini, "Scheduler", "MinIntervalMs", minInterval);
+	Utils::loadINIIntSetting(ini, "Scheduler", "MaxIntervalMs", maxInterval);
+	scheduler->setIntervals(std::chrono::milliseconds(minInterval), std::chrono::milliseconds(maxInterval));
+
+	const auto governor = FrameGovernor::GetSingleton();
+	FrameGovernor::Config governorConfig = governor->getConfig();
+	Utils::loadINIBoolSetting(ini, "Governor", "Enabled", governorConfig.enabled);
+	Utils::loadINIFloatSetting(ini, "Governor", "TargetMs", governorConfig.targetMs);
+	Utils::loadINIFloatSetting(ini, "Governor", "Percentile", governorConfig.percentile);
+	Utils::loadINIFloatSetting(ini, "Governor", "RestoreRatio", governorConfig.restoreRatio);
+
+	// effect = priority, lower is shed first, effects without an entry are never shed
+	std::vector<FrameGovernor::Candidate> candidates;
+	CSimpleIniA::TNamesDepend effects;
+	ini.GetAllKeys("GovernorEffects", effects);
+	for (const auto& effect : effects)
+	{
+		FrameGovernor::Candidate candidate;
+		candidate.effect = EffectTable::GetSingleton()->intern(effect.pItem);
+		candidate.priority = static_cast<int>(ini.GetLongValue("GovernorEffects", effect.pItem, 0));
+		if (candidate.effect != EffectTable::s_invalidID && candidate.effect != EffectTable::s_entireReShade)
+		{
+			candidates.push_back(candidate);
+		}
+	}
+	governor->configure(governorConfig, std::move(candidates));
+
+	const auto prewarmer = EffectPrewarmer::GetSingleton();
+	bool prewarm = prewarmer->isEnabled();
+	int lookahead = prewarmer->getLookaheadMinutes();
+	int prewarmInterval = static_cast<int>(prewarmer->getInterval().count());
+	Utils::loadINIBoolSetting(ini, "Prewarm", "Enabled", prewarm);
+	Utils::loadINIIntSetting(ini, "Prewarm", "LookaheadMinutes", lookahead);
+	Utils::loadINIIntSetting(ini, "Prewarm", "IntervalMs", prewarmInterval);
+	prewarmer->setEnabled(prewarm);
+	prewarmer->setLookaheadMinutes(lookahead);
+	prewarmer->setInterval(std::chrono::milliseconds(prewarmInterval));
+
+	int compileThreads = static_cast<int>(CompilePool::GetSingleton()->getConfiguredThreadCount());
+	Utils::loadINIIntSetting(ini, "Compile", "Threads", compileThreads);
+	CompilePool::GetSingleton()->setThreadCount(static_cast<std::uint32_t>(std::max(compileThreads, 0)));
 
 }
 
@@ -72,8 +218,10 @@ void Manager::serializeINI()
 
 	CSimpleIniA ini;
 	ini.SetUnicode();
+	ini.LoadFile(path.c_str()); // keep the other sections
 
 	ini.SetValue("Preset", "LastPreset", m_lastPresetName.c_str());
+	ini.SetBoolValue("Journal", "Enabled", m_journalEnabled);
 	ini.SaveFile(path.c_str());
 
 }
@@ -101,16 +249,18 @@ std::vector<std::string> Manager::enumerateEffects() const
 {
 	std::vector<std::string> effects;
 
-	s_pRuntime->enumerate_techniques(nullptr, [&](reshade::api::effect_runtime* runtime, reshade::api::effect_technique technique) {
-		char nameBuffer[128] = "";
+	RuntimeRegistry::GetSingleton()->withPrimary([&](reshade::api::effect_runtime* primary) {
+		primary->enumerate_techniques(nullptr, [&](reshade::api::effect_runtime* runtime, reshade::api::effect_technique technique) {
+			char nameBuffer[128] = "";
 
-		runtime->get_technique_effect_name(technique, nameBuffer);
+			runtime->get_technique_effect_name(technique, nameBuffer);
 
-		if (std::find(effects.begin(), effects.end(), nameBuffer) == effects.end())
-		{
-			effects.emplace_back(nameBuffer);
-		}
+			if (std::find(effects.begin(), effects.end(), nameBuffer) == effects.end())
+			{
+				effects.emplace_back(nameBuffer);
+			}
 
+			});
 		});
 
 	std::sort(effects.begin(), effects.end());
@@ -205,15 +355,20 @@ std::string Manager::constructKey(const RE::TESForm* form) const
 
 void Manager::toggleEffectMenu(const std::string& menu, const bool opening)
 {
+	PROFILE_ZONE(Profiler::Zone::ToggleEffectMenu);
+
+	std::scoped_lock lock(m_dataLock);
+
 	auto it = m_menuToggleInfo.find(menu);
 	if (it == m_menuToggleInfo.end())
 		return;
 
-	static std::unordered_map<std::string, uint16_t> usage;
-
 	for (auto& info : it->second)
 	{
-		auto& effectUsageCount = usage[info.effectName];
+		if (info.effectID == EffectTable::s_invalidID)
+			continue;
+
+		auto& effectUsageCount = m_menuEffectUsage[info.effectID];
 
 		if (opening)
 		{
@@ -221,10 +376,12 @@ void Manager::toggleEffectMenu(const std::string& menu, const bool opening)
 			{
 				if (effectUsageCount == 0) // not active yet
 				{
-					toggleEffect(info.effectName.c_str(), info.state);
+					toggleEffect(info.effectID, info.state, Journal::Source::Menu, info.id, info.timing);
 				}
 				effectUsageCount++;
 				info.isToggled = true;
+
+				applyRuleUniforms(info.effectID, info.uniforms, Journal::Source::Menu, info.id);
 			}
 		}
 		else
@@ -234,340 +391,1131 @@ void Manager::toggleEffectMenu(const std::string& menu, const bool opening)
 				effectUsageCount--;
 				if (effectUsageCount == 0) // effect isnt needed anymore
 				{
-					toggleEffect(info.effectName.c_str(), !info.state);
-					usage.erase(info.effectName);
+					toggleEffect(info.effectID, !info.state, Journal::Source::Menu, info.id, info.timing);
 				}
 				info.isToggled = false;
+
+				releaseRuleUniforms(info.id);
 			}
 		}
+	}
+}
 
-		for (auto& uniform : info.uniforms)
-		{
-			setUniformValues(uniform);
-		}
+void Manager::applyRuleUniforms(EffectTable::ID effect, std::vector<UniformInfo>& uniforms, Journal::Source source, std::uint64_t ruleID)
+{
+	const auto baseline = UniformBaseline::GetSingleton();
+	for (auto& uniform : uniforms)
+	{
+		baseline->hold(ruleID, effect, uniform.uniformName);
+		setUniformValues(effect, uniform, source, ruleID);
 	}
 }
 
-void Manager::setUniformValues(UniformInfo& uniform)
+void Manager::setUniformValues(EffectTable::ID effect, UniformInfo& uniform, Journal::Source source, std::uint64_t ruleID)
 {
-	const auto manager = Manager::GetSingleton();
+	const auto bindings = UniformBindings::GetSingleton();
+	const auto animator = UniformAnimator::GetSingleton();
+	const auto transitions = UniformTransitions::GetSingleton();
+	if (uniform.binding.isActive())
+	{
+		transitions->cancel(effect, uniform.uniformName);
+		animator->unbind(effect, uniform.uniformName);
+		bindings->bind(effect, uniform.uniformName, uniform.binding, source, ruleID);
+		return;
+	}
+	bindings->unbind(effect, uniform.uniformName);
+
+	if (uniform.curve)
+	{
+		transitions->cancel(effect, uniform.uniformName);
+		animator->bind(effect, uniform.uniformName, uniform.curve, source, ruleID);
+		return;
+	}
+	animator->unbind(effect, uniform.uniformName);
+
+	const auto queue = CommandQueue::GetSingleton();
+
+	auto setAndRecord = [&]<typename T>(T* values, size_t count) {
+		queue->pushSetUniform<T>(effect, uniform.uniformName.c_str(), values, count, source, ruleID);
+		};
 
 	if (!uniform.floatValues.empty())
 	{
-		manager->setUniformValue<float>(uniform.uniformVariable, uniform.floatValues.data(), uniform.floatValues.size());
+		transitions->setUniform(effect, uniform.uniformName, uniform.floatValues.data(), uniform.floatValues.size(), source, ruleID);
 	}
 	else if (!uniform.intValues.empty())
 	{
-		manager->setUniformValue<int>(uniform.uniformVariable, uniform.intValues.data(), uniform.intValues.size());
+		setAndRecord(uniform.intValues.data(), uniform.intValues.size());
 	}
 	else if (!uniform.uintValues.empty())
 	{
-		manager->setUniformValue<unsigned int>(uniform.uniformVariable, uniform.uintValues.data(), uniform.uintValues.size());
+		setAndRecord(uniform.uintValues.data(), uniform.uintValues.size());
 	}
 	else if (uniform.boolValue == 0 || uniform.boolValue == 1)
 	{
 		bool tempBoolValue = static_cast<bool>(uniform.boolValue);
-		manager->setUniformValue<bool>(uniform.uniformVariable, &tempBoolValue, 1);
+		setAndRecord(&tempBoolValue, 1);
 	}
 }
 
-bool Manager::allowtoggleEffectWeather(const WeatherToggleInformation& cachedweather, const std::map<std::string, std::vector<WeatherToggleInformation>>::iterator& it) const
+void Manager::toggleEffectWeather()
+{
+	PROFILE_ZONE(Profiler::Zone::ToggleEffectWeather);
+
+	std::scoped_lock lock(m_dataLock);
+
+	const auto sky = RE::Sky::GetSingleton();
+	const auto player = RE::PlayerCharacter::GetSingleton();
+	const auto ui = RE::UI::GetSingleton();
+
+	if (m_weatherToggleInfo.empty() || !player || !sky || !sky->currentWeather || !ui)
+		return;
+
+	RE::TESForm* ws = player->GetWorldspace();
+
+	const PassFingerprint::Value fingerprint{
+		.form = ws ? ws->formID : 0,
+		.detail = sky->currentWeather->formID,
+		.paused = ui->GameIsPaused()
+	};
+	if (m_fingerprints[static_cast<std::size_t>(TickScheduler::Pass::Weather)].matches(fingerprint) || fingerprint.paused)
+		return;
+
+	ToggleSource<WeatherSource>::evaluate(*this, m_weatherToggleInfo, m_weatherToggleCache, { ws, constructKey(sky->currentWeather) });
+}
+
+void Manager::toggleEffectTime()
 {
-	if (it == m_weatherToggleInfo.end())
-		return true;
+	PROFILE_ZONE(Profiler::Zone::ToggleEffectTime);
+
+	std::scoped_lock lock(m_dataLock);
+
+	const auto ui = RE::UI::GetSingleton();
+	const auto player = RE::PlayerCharacter::GetSingleton();
+	if (m_timeToggleInfo.empty() || !player || !RE::Calendar::GetSingleton() || !ui)
+		return;
 
-	for (const auto& newInfo : it->second)
+	RE::TESForm* ws = player->GetWorldspace();
+	if (!ws)
 	{
-		if (cachedweather.effectName == newInfo.effectName &&
-			cachedweather.state == newInfo.state &&
-			cachedweather.weather == newInfo.weather)
+		ws = player->GetParentCell();
+	}
+
+	const std::uint16_t minute = GameTime::getCurrentMinute();
+	const std::uint32_t day = GameTime::getCurrentDay();
+
+	// within a segment between two boundaries no rule can flip, the next boundary identifies the segment
+	const PassFingerprint::Value fingerprint{
+		.form = ws ? ws->formID : 0,
+		.detail = day,
+		.bucket = GameTime::findNext(m_timeBoundaries, minute),
+		.paused = ui->GameIsPaused()
+	};
+	if (m_fingerprints[static_cast<std::size_t>(TickScheduler::Pass::Time)].matches(fingerprint) || fingerprint.paused)
+		return;
+
+	// date conditions can only change with the day
+	if (m_timeRuleDatesDirty || day != m_timeRuleDay)
+	{
+		const std::uint32_t date = GameTime::getCurrentDate();
+		for (auto& [key, infos] : m_timeToggleInfo)
 		{
-			return false;
+			for (auto& info : infos)
+			{
+				info.activeToday = GameTime::matchesDate(info.dateMask, date);
+			}
 		}
+		m_timeRuleDay = day;
+		m_timeRuleDatesDirty = false;
 	}
 
-	return true;
+	ToggleSource<TimeSource>::evaluate(*this, m_timeToggleInfo, m_timeToggleCache, { ws, minute });
+}
+
+void Manager::toggleEffectInterior(const bool isInterior)
+{
+	PROFILE_ZONE(Profiler::Zone::ToggleEffectInterior);
+
+	std::scoped_lock lock(m_dataLock);
+
+	const auto player = RE::PlayerCharacter::GetSingleton();
+	if (m_interiorToggleInfo.empty() || !player)
+		return;
+
+	RE::TESForm* cell = player->GetParentCell();
+	ToggleSource<InteriorSource>::evaluate(*this, m_interiorToggleInfo, m_interiorToggleCache, { isInterior ? cell : nullptr });
+}
+
+void Manager::compileRules()
+{
+	m_ruleStore.clear();
+	m_ruleStore.reserve(m_ruleToggleInfo.size());
+
+	for (const auto& info : m_ruleToggleInfo)
+	{
+		m_ruleStore.add(Rules::compile(info));
+	}
+
+	m_ruleResults.assign(m_ruleStore.resultWords(), 0);
+	m_rulesDirty = false;
+	m_fingerprints[static_cast<std::size_t>(TickScheduler::Pass::Rules)].invalidate();
+}
+
+void Manager::toggleEffectRules()
+{
+	PROFILE_ZONE(Profiler::Zone::ToggleEffectRules);
+
+	std::scoped_lock lock(m_dataLock);
+
+	if (m_ruleToggleInfo.empty() || !RE::PlayerCharacter::GetSingleton() || !RE::Calendar::GetSingleton())
+		return;
+
+	if (m_rulesDirty)
+	{
+		compileRules();
+	}
+
+	// the rules only see the packed state, the same state gives the same results
+	const std::uint32_t state = Rules::captureGameState();
+	if (m_fingerprints[static_cast<std::size_t>(TickScheduler::Pass::Rules)].matches({ .detail = state }))
+		return;
+
+	Rules::evaluate(m_ruleStore, state, m_ruleResults);
+
+	for (size_t i = 0; i < m_ruleToggleInfo.size(); i++)
+	{
+		auto& info = m_ruleToggleInfo[i];
+		const bool active = (m_ruleResults[i / 64] >> (i % 64)) & 1;
+
+		if (active == info.isToggled)
+			continue;
+
+		toggleEffect(info.effectID, active ? info.state : !info.state, Journal::Source::Rule, info.id, info.timing);
+		info.isToggled = active;
+
+		if (active)
+		{
+			applyRuleUniforms(info.effectID, info.uniforms, Journal::Source::Rule, info.id);
+		}
+		else
+		{
+			releaseRuleUniforms(info.id);
+		}
+	}
+}
+
+void Manager::prewarmUpcomingEffects()
+{
+	const auto prewarmer = EffectPrewarmer::GetSingleton();
+	const auto player = RE::PlayerCharacter::GetSingleton();
+	if (!prewarmer->isEnabled() || !player)
+		return;
+
+	std::scoped_lock lock(m_dataLock);
+
+	if (const auto ws = player->GetWorldspace())
+	{
+		const auto key = constructKey(ws);
+
+		// time rules of this worldspace whose window opens within the lookahead
+		if (const auto it = m_timeToggleInfo.find(key); it != m_timeToggleInfo.end() && RE::Calendar::GetSingleton())
+		{
+			const std::uint16_t minute = GameTime::getCurrentMinute();
+			const int lookahead = prewarmer->getLookaheadMinutes();
+
+			for (const auto& info : it->second)
+			{
+				if (!info.state || !info.activeToday || GameTime::contains(info.minuteMask, minute))
+					continue;
+
+				for (int step = 1; step <= lookahead; step++)
+				{
+					if (GameTime::contains(info.minuteMask, static_cast<std::uint16_t>((minute + step) % GameTime::kMinutesPerDay)))
+					{
+						prewarmer->request(info.effectID);
+						break;
+					}
+				}
+			}
+		}
+
+		// every weather rule of this worldspace is one weather change away
+		if (const auto it = m_weatherToggleInfo.find(key); it != m_weatherToggleInfo.end())
+		{
+			for (const auto& info : it->second)
+			{
+				if (info.state)
+				{
+					prewarmer->request(info.effectID);
+				}
+			}
+		}
+	}
+
+	// interiors behind the load doors of the current cell
+	const auto cell = player->GetParentCell();
+	if (!cell || m_interiorToggleInfo.empty())
+		return;
+
+	cell->ForEachReference([&](RE::TESObjectREFR& ref) {
+		const auto teleport = ref.extraList.GetByType<RE::ExtraTeleport>();
+		if (!teleport || !teleport->teleportData)
+			return RE::BSContainer::ForEachResult::kContinue;
+
+		const auto door = teleport->teleportData->linkedDoor.get();
+		if (!door)
+			return RE::BSContainer::ForEachResult::kContinue;
+
+		if (const auto it = m_interiorToggleInfo.find(constructKey(door->GetParentCell())); it != m_interiorToggleInfo.end())
+		{
+			for (const auto& info : it->second)
+			{
+				if (info.state)
+				{
+					prewarmer->request(info.effectID);
+				}
+			}
+		}
+		return RE::BSContainer::ForEachResult::kContinue;
+		});
+}
+
+void Manager::compileTimeRule(TimeToggleInformation& info, GameTime::MinuteMask& boundaries)
+{
+	if (info.windows.empty())
+	{
+		info.windows.push_back({ GameTime::fromLegacyTime(info.startTime), GameTime::fromLegacyTime(info.stopTime) });
+		info.startTime = 0.f;
+		info.stopTime = 0.f;
+	}
+	info.minuteMask = GameTime::buildMask(info.windows);
+	info.dateMask = GameTime::buildDateMask(info.days, info.months, info.seasons);
+
+	// every minute where the rule flips, midnight too if the day matters
+	for (std::uint16_t minute = 0; minute < GameTime::kMinutesPerDay; minute++)
+	{
+		const std::uint16_t previous = minute == 0 ? GameTime::kMinutesPerDay - 1 : minute - 1;
+		if (GameTime::contains(info.minuteMask, minute) != GameTime::contains(info.minuteMask, previous))
+		{
+			boundaries[minute >> 6] |= 1ull << (minute & 63);
+		}
+	}
+
+	if (info.dateMask != (GameTime::kWeekdayBits | GameTime::kMonthBits))
+	{
+		boundaries[0] |= 1ull;
+	}
+}
+
+void Manager::compileTimeRules(std::map<std::string, std::vector<TimeToggleInformation>>& map)
+{
+	m_timeBoundaries = {};
+
+	for (auto& [key, infos] : map)
+	{
+		for (auto& info : infos)
+		{
+			compileTimeRule(info, m_timeBoundaries);
+		}
+	}
+
+	m_timeRuleDatesDirty = true;
+	m_fingerprints[static_cast<std::size_t>(TickScheduler::Pass::Time)].invalidate();
+}
+
+void Manager::compilePreset(const CompileSources& sources, GameTime::MinuteMask& timeBoundaries, Rules::RuleStore& ruleStore, std::uint32_t threads)
+{
+	std::vector<CompilePool::Task> tasks;
+
+	// a key with far more rules than the others is split, so its chunks can be stolen by idle workers
+	const auto forEachChunk = []<typename T, typename Func>(std::vector<T>& infos, Func&& func) {
+		for (size_t begin = 0; begin < infos.size(); begin += s_compileChunk)
+		{
+			func(std::span<T>(infos).subspan(begin, std::min(s_compileChunk, infos.size() - begin)));
+		}
+		};
+
+	const auto addChunks = [&]<typename T>(std::map<std::string, std::vector<T>>& map) {
+		for (auto& [key, infos] : map)
+		{
+			forEachChunk(infos, [&tasks](std::span<T> chunk) { tasks.emplace_back([chunk]() { compileChunk(chunk); }); });
+		}
+		};
+
+	addChunks(sources.menu);
+	addChunks(sources.weather);
+	addChunks(sources.interior);
+
+	// every chunk collects its own boundaries, they are merged once all ran
+	std::vector<GameTime::MinuteMask> chunkBoundaries;
+	for (auto& [key, infos] : sources.time)
+	{
+		forEachChunk(infos, [&](std::span<TimeToggleInformation> chunk) {
+			const size_t slot = chunkBoundaries.size();
+			chunkBoundaries.emplace_back();
+			tasks.emplace_back([chunk, slot, &chunkBoundaries]() {
+				compileChunk(chunk);
+				for (auto& info : chunk)
+				{
+					compileTimeRule(info, chunkBoundaries[slot]);
+				}
+				});
+			});
+	}
+
+	// compound rules compile into place, the store is filled in order afterwards
+	std::vector<Rules::CompiledRule> compiled(sources.rules.size());
+	forEachChunk(sources.rules, [&](std::span<RuleToggleInformation> chunk) {
+		const size_t offset = chunk.data() - sources.rules.data();
+		tasks.emplace_back([chunk, offset, &compiled]() {
+			compileChunk(chunk);
+			for (size_t i = 0; i < chunk.size(); i++)
+			{
+				compiled[offset + i] = Rules::compile(chunk[i]);
+			}
+			});
+		});
+
+	CompilePool::GetSingleton()->run(tasks, threads);
+
+	timeBoundaries = {};
+	for (const auto& boundaries : chunkBoundaries)
+	{
+		for (size_t word = 0; word < timeBoundaries.size(); word++)
+		{
+			timeBoundaries[word] |= boundaries[word];
+		}
+	}
+
+	ruleStore.clear();
+	ruleStore.reserve(compiled.size());
+	for (const auto& rule : compiled)
+	{
+		ruleStore.add(rule);
+	}
+}
+
+std::vector<Manager::CompileBenchmarkResult> Manager::runCompileBenchmark(size_t ruleCount)
+{
+	std::vector<CompileBenchmarkResult> results;
+
+	// effects that are interned already, the benchmark doesn't grow the effect table
+	const auto table = EffectTable::GetSingleton();
+	const size_t effectCount = table->size();
+
+	std::mt19937 rng(1337);
+	const auto pick = [&rng](int count) { return static_cast<int>(rng() % count); };
+
+	std::map<std::string, std::vector<MenuToggleInformation>> menu;
+	std::map<std::string, std::vector<TimeToggleInformation>> time;
+	std::map<std::string, std::vector<WeatherToggleInformation>> weather;
+	std::map<std::string, std::vector<InteriorToggleInformation>> interior;
+	std::vector<RuleToggleInformation> rules;
+
+	// shaped like the large community presets: most rules in one worldspace, the rest spread thin
+	const auto keyFor = [&pick](int keys) { return std::format("{:08X}|Benchmark|Skyrim.esm", pick(4) == 0 ? pick(keys) : 0); };
+	const auto addUniforms = [&pick](std::vector<UniformInfo>& uniforms) {
+		UniformInfo& uniform = uniforms.emplace_back();
+		uniform.uniformName = "Benchmark";
+		for (int k = 0; k < 4; k++)
+		{
+			uniform.keyframes.push_back({ static_cast<float>(pick(24)), { static_cast<float>(pick(100)) / 100.f } });
+		}
+		};
+
+	for (size_t i = 0; i < ruleCount; i++)
+	{
+		const std::string effectName = table->getName(static_cast<EffectTable::ID>(i % effectCount));
+		switch (i % 5)
+		{
+		case 0:
+			{
+				auto& info = menu[std::format("Menu{}", pick(20))].emplace_back();
+				info.effectName = effectName;
+				addUniforms(info.uniforms);
+				break;
+			}
+		case 1:
+			{
+				auto& info = time[keyFor(200)].emplace_back();
+				info.effectName = effectName;
+				info.windows.push_back({ static_cast<std::uint16_t>(pick(GameTime::kMinutesPerDay)), static_cast<std::uint16_t>(pick(GameTime::kMinutesPerDay)) });
+				addUniforms(info.uniforms);
+				break;
+			}
+		case 2:
+			{
+				auto& info = weather[keyFor(200)].emplace_back();
+				info.effectName = effectName;
+				info.weather = std::format("{:08X}|Weather|Skyrim.esm", pick(50));
+				addUniforms(info.uniforms);
+				break;
+			}
+		case 3:
+			{
+				auto& info = interior[keyFor(2000)].emplace_back();
+				info.effectName = effectName;
+				addUniforms(info.uniforms);
+				break;
+			}
+		default:
+			{
+				auto& info = rules.emplace_back();
+				info.effectName = effectName;
+				info.startHour = pick(24);
+				info.stopHour = pick(24);
+				info.location = Rules::s_locationOptions[pick(3)];
+				info.menu = Rules::s_menuOptions[pick(3)];
+				addUniforms(info.uniforms);
+				break;
+			}
+		}
+	}
+
+	const CompileSources sources{ menu, time, weather, interior, rules };
+
+	// curves are only sampled while missing, dropping them makes every run do the full work
+	const auto resetCurves = []<typename T>(std::vector<T>& infos) {
+		for (auto& info : infos)
+		{
+			for (auto& uniform : info.uniforms)
+			{
+				uniform.curve.reset();
+			}
+		}
+		};
+	const auto resetAllCurves = [&]() {
+		for (auto& [key, infos] : menu) { resetCurves(infos); }
+		for (auto& [key, infos] : time) { resetCurves(infos); }
+		for (auto& [key, infos] : weather) { resetCurves(infos); }
+		for (auto& [key, infos] : interior) { resetCurves(infos); }
+		resetCurves(rules);
+		};
+
+	double baselineMs = 0.0;
+	for (const std::uint32_t threads : { 1u, 2u, 4u, 8u })
+	{
+		constexpr int iterations = 3;
+
+		GameTime::MinuteMask boundaries{};
+		Rules::RuleStore store;
+		double totalMs = 0.0;
+
+		for (int iteration = 0; iteration < iterations; iteration++)
+		{
+			resetAllCurves();
+
+			const auto start = std::chrono::steady_clock::now();
+			compilePreset(sources, boundaries, store, threads);
+			totalMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+		}
+
+		CompileBenchmarkResult result;
+		result.ruleCount = ruleCount;
+		result.threads = threads;
+		result.ms = totalMs / iterations;
+		if (threads == 1)
+		{
+			baselineMs = result.ms;
+		}
+		result.speedup = result.ms > 0.0 ? baselineMs / result.ms : 0.0;
+		results.emplace_back(result);
+	}
+
+	return results;
+}
+
+TickScheduler::Clock::duration Manager::toRealTime(float gameMinutes)
+{
+	const float timescale = RE::Calendar::GetSingleton()->GetTimescale();
+	if (timescale <= 0.f)
+		return TickScheduler::s_never; // time is frozen
+
+	// anything past a day is clamped to the longest interval anyway
+	const float seconds = std::min(gameMinutes * 60.f / timescale, 86400.f);
+	return std::chrono::duration_cast<TickScheduler::Clock::duration>(std::chrono::duration<float>(seconds));
+}
+
+TickScheduler::Clock::duration Manager::getNextWeatherChange() const
+{
+	std::scoped_lock lock(m_dataLock);
+
+	if (m_weatherToggleInfo.empty())
+		return TickScheduler::s_never;
+
+	if (const auto ui = RE::UI::GetSingleton(); ui && ui->GameIsPaused())
+		return TickScheduler::s_never; // woken once the menu closes
+
+	// the sky doesn't announce the next weather, outside of a transition it is polled at the longest interval
+	const auto sky = RE::Sky::GetSingleton();
+	if (sky && sky->currentWeatherPct < 1.f)
+		return TickScheduler::Clock::duration::zero();
+
+	return TickScheduler::GetSingleton()->getMaxInterval();
+}
+
+TickScheduler::Clock::duration Manager::getNextTimeChange() const
+{
+	std::scoped_lock lock(m_dataLock);
+
+	if (m_timeToggleInfo.empty() || !RE::Calendar::GetSingleton())
+		return TickScheduler::s_never;
+
+	if (const auto ui = RE::UI::GetSingleton(); ui && ui->GameIsPaused())
+		return TickScheduler::s_never;
+
+	const auto next = GameTime::findNext(m_timeBoundaries, GameTime::getCurrentMinute());
+	if (next == GameTime::kMinutesPerDay)
+		return TickScheduler::s_never; // only worldspace changes can matter
+
+	return toRealTime(GameTime::getMinutesUntil(next));
+}
+
+TickScheduler::Clock::duration Manager::getNextRulesChange() const
+{
+	{
+		std::scoped_lock lock(m_dataLock);
+		if (m_ruleToggleInfo.empty() || !RE::Calendar::GetSingleton())
+			return TickScheduler::s_never;
+	}
+
+	// hours change on the hour, weathers like the weather pass, menus and cells wake the pass themselves
+	const auto calendar = RE::Calendar::GetSingleton();
+	const auto nextHour = static_cast<std::uint16_t>(((std::clamp(static_cast<int>(calendar->GetHour()), 0, 23) + 1) % 24) * 60);
+	const auto hourChange = toRealTime(GameTime::getMinutesUntil(nextHour));
+
+	return std::min<TickScheduler::Clock::duration>(hourChange, TickScheduler::GetSingleton()->getMaxInterval());
+}
+
+void Manager::toggleEffect(const char* effect, const bool state, Journal::Source source, std::uint64_t ruleID) const
+{
+	toggleEffect(EffectTable::GetSingleton()->intern(effect), state, source, ruleID);
+}
+
+void Manager::toggleEffect(EffectTable::ID effect, const bool state, Journal::Source source, std::uint64_t ruleID, const ToggleTiming& timing) const
+{
+	if (effect == EffectTable::s_entireReShade)
+	{
+		toggleReshade(state, source);
+	}
+	else if (effect != EffectTable::s_invalidID && ToggleDebouncer::GetSingleton()->request(effect, state, source, ruleID, timing))
+	{
+		CommandQueue::GetSingleton()->pushToggleEffect(effect, state, source, ruleID);
+	}
+}
+
+void Manager::toggleReshade(const bool state, Journal::Source source) const
+{
+	CommandQueue::GetSingleton()->pushToggleReShade(state, source);
+}
+
+void Manager::executeCommands()
+{
+	std::unique_lock drainLock(m_drainLock, std::try_to_lock);
+	if (!drainLock.owns_lock())
+		return;
+
+	// the reverts of a preset switch wait for the new preset's first evaluation, so both land in the same frame
+	const auto presetSwitch = m_presetSwitch.load(std::memory_order_acquire);
+	if (presetSwitch == PresetSwitch::Evaluating && m_presetSwitchHeldFrames < s_maxPresetSwitchHeldFrames)
+	{
+		m_presetSwitchHeldFrames++;
+		return;
+	}
+
+	PROFILE_ZONE(Profiler::Zone::ExecuteCommands);
+
+	const auto governor = FrameGovernor::GetSingleton();
+
+	m_commandBatch.clear();
+	CommandQueue::GetSingleton()->drain([&](const CommandQueue::Command& command) {
+		governor->observe(command); // before coalescing, every toggle counts for what a shed effect returns to
+		m_commandBatch.emplace_back(command);
+		});
+
+	if (presetSwitch == PresetSwitch::Ready)
+	{
+		auto expected = PresetSwitch::Ready;
+		m_presetSwitch.compare_exchange_strong(expected, PresetSwitch::None, std::memory_order_acq_rel);
+		m_presetSwitchHeldFrames = 0;
+	}
+
+	if (m_commandBatch.empty())
+		return;
+
+	coalesceToggles();
+
+	// past the hold limit the batches go out the normal way, the snapshot is only taken once for the evaluated preset
+	if (presetSwitch == PresetSwitch::Ready)
+	{
+		applyPresetSwitch();
+		return;
+	}
+
+	// the journal only records the writes of the first runtime, the others receive the same values
+	bool record = true;
+	RuntimeRegistry::GetSingleton()->forEach([&](RuntimeRegistry::Entry& entry) {
+		for (const auto& command : m_commandBatch)
+		{
+			applyCommand(entry, command, record);
+		}
+		record = false;
+		});
+}
+
+void Manager::coalesceToggles()
+{
+	std::uint32_t latestReShade = 0;
+	for (std::uint32_t i = 0; i < m_commandBatch.size(); i++)
+	{
+		const auto& command = m_commandBatch[i];
+		if (command.type == CommandQueue::Type::ToggleEffect && command.effect < EffectTable::s_capacity)
+		{
+			m_pendingToggles[command.effect] = i + 1;
+		}
+		else if (command.type == CommandQueue::Type::ToggleReShade)
+		{
+			latestReShade = i + 1;
+		}
+	}
+
+	// commands keep their order, only toggles overwritten later in the same frame drop out
+	size_t kept = 0;
+	for (std::uint32_t i = 0; i < m_commandBatch.size(); i++)
+	{
+		const auto& command = m_commandBatch[i];
+
+		bool keep = true;
+		if (command.type == CommandQueue::Type::ToggleEffect && command.effect < EffectTable::s_capacity)
+		{
+			keep = m_pendingToggles[command.effect] == i + 1;
+		}
+		else if (command.type == CommandQueue::Type::ToggleReShade)
+		{
+			keep = latestReShade == i + 1;
+		}
+
+		if (keep)
+		{
+			m_commandBatch[kept++] = command;
+		}
+	}
+
+	m_coalescedToggles += m_commandBatch.size() - kept;
+	m_commandBatch.resize(kept);
+
+	for (const auto& command : m_commandBatch)
+	{
+		if (command.type == CommandQueue::Type::ToggleEffect && command.effect < EffectTable::s_capacity)
+		{
+			m_pendingToggles[command.effect] = 0;
+		}
+	}
+}
+
+void Manager::applyPresetSwitch()
+{
+	m_presetSwitchStats = {};
+
+	bool record = true;
+	RuntimeRegistry::GetSingleton()->forEach([&](RuntimeRegistry::Entry& entry) {
+		StateSnapshot snapshot(entry);
+		for (const auto& command : m_commandBatch)
+		{
+			snapshot.fold(command);
+		}
+
+		// unchanged commands still keep the uniform baselines in step
+		snapshot.forEach([&](const CommandQueue::Command& command, bool changes) {
+			applyCommand(entry, command, record, changes);
+
+			if (record)
+			{
+				(changes ? m_presetSwitchStats.writes : m_presetSwitchStats.skipped)++;
+			}
+			});
+
+		if (record)
+		{
+			m_presetSwitchStats.dropped = static_cast<std::uint32_t>(m_commandBatch.size()) - m_presetSwitchStats.writes - m_presetSwitchStats.skipped;
+		}
+		record = false;
+		});
 }
 
-bool Manager::allowtoggleEffectTime(const TimeToggleInformation& cachedweather, const std::map<std::string, std::vector<TimeToggleInformation>>::iterator& it) const
+void Manager::evaluatePresetSwitch()
 {
-	if (it == m_timeToggleInfo.end())
-		return true;
+	if (m_presetSwitch.load(std::memory_order_acquire) != PresetSwitch::Evaluating)
+		return;
 
-	for (const auto& newInfo : it->second)
+	// menus that are already open pick up the new preset's menu rules right away
+	std::vector<std::string> menus;
 	{
-		if (cachedweather.effectName == newInfo.effectName &&
-			cachedweather.state == newInfo.state &&
-			timeWithinRange(newInfo.startTime, newInfo.stopTime))
+		std::scoped_lock lock(m_dataLock);
+		for (const auto& [menu, infos] : m_menuToggleInfo)
 		{
-			return false;
+			menus.emplace_back(menu);
 		}
 	}
 
-	return true;
-}
-
-bool Manager::allowtoggleEffectInterior(const InteriorToggleInformation& cachedInterior, const std::map<std::string, std::vector<InteriorToggleInformation>>::iterator& it) const
-{
-	if (it == m_interiorToggleInfo.end())
-		return true;
-
-	for (const auto& newInfo : it->second)
+	if (const auto ui = RE::UI::GetSingleton())
 	{
-		if (cachedInterior.effectName == newInfo.effectName &&
-			cachedInterior.state == newInfo.state)
+		for (const auto& menu : menus)
 		{
-			return false;
+			if (ui->IsMenuOpen(menu))
+			{
+				toggleEffectMenu(menu, true);
+			}
 		}
 	}
 
-	return true;
+	const auto player = RE::PlayerCharacter::GetSingleton();
+	const auto cell = player ? player->GetParentCell() : nullptr;
+	toggleEffectInterior(cell && cell->IsInteriorCell());
+	toggleEffectWeather();
+	toggleEffectTime();
+	toggleEffectRules();
+
+	auto expected = PresetSwitch::Evaluating;
+	m_presetSwitch.compare_exchange_strong(expected, PresetSwitch::Ready, std::memory_order_acq_rel);
 }
 
-void Manager::toggleEffectWeather()
+void Manager::applyCommand(RuntimeRegistry::Entry& entry, const CommandQueue::Command& command, bool record, bool write)
 {
-	const auto sky = RE::Sky::GetSingleton();
-	const auto player = RE::PlayerCharacter::GetSingleton();
-	const auto ui = RE::UI::GetSingleton();
+	const auto journal = Journal::GetSingleton();
+	const auto runtime = entry.runtime;
+	const char* effectName = EffectTable::GetSingleton()->getName(command.effect);
 
-	if (m_weatherToggleInfo.empty() || !player || !sky || !sky->currentWeather || !ui || ui->GameIsPaused())
-		return;
+	switch (command.type)
+	{
+	case CommandQueue::Type::ToggleEffect:
+	{
+		PROFILE_ZONE(Profiler::Zone::ToggleEffect);
 
-	RE::TESForm* ws = player->GetWorldspace();
-	const auto it = m_weatherToggleInfo.find(constructKey(ws));
-	const auto cachedWorldspace = m_weatherToggleCache.first;
+		if (!write || command.effect >= EffectTable::GetSingleton()->size())
+			break;
 
-	if (!ws || cachedWorldspace && cachedWorldspace->formID != ws->formID) // player is in interior or changed worldspace
-	{
-		if (cachedWorldspace)
+		// shed by the frame governor, it is enabled again once the frame time allows it
+		if (command.state && command.source != Journal::Source::Governor && FrameGovernor::GetSingleton()->isShed(command.effect))
+			break;
+
+		const auto& techniques = entry.getTechniques(command.effect);
+		bool oldState = command.state;
+		for (size_t i = 0; i < techniques.size(); i++)
 		{
-			for (const auto& info : m_weatherToggleCache.second)
+			const bool state = runtime->get_technique_state(techniques[i]);
+			if (i == 0)
 			{
-				if (!ws || allowtoggleEffectWeather(info, it)) // change effect state back to original if it was toggled before
-				{
-					toggleEffect(info.effectName.c_str(), !info.state);
-				}
+				oldState = state; // the journal reports the first technique
 			}
-			m_weatherToggleCache.first = nullptr;
-			m_weatherToggleCache.second.clear();
-		}
-		return;
-	}
 
-	if (it == m_weatherToggleInfo.end()) // no info for ws in unordered map
-		return;
-
-	const std::string weather = constructKey(sky->currentWeather);
+			if (state != command.state) // an unchanged state must not rebuild the effect chain
+			{
+				runtime->set_technique_state(techniques[i], command.state); // True = enabled; False = disabled
+			}
+		}
 
-	for (auto& info : it->second)
-	{
-		if (info.id == 0)
+		if (record && !techniques.empty())
 		{
-			info.id = IDGenerator::getNextID();
+			journal->recordTechnique(command.source, command.ruleID, effectName, oldState, command.state);
 		}
+	}
+	break;
+	case CommandQueue::Type::PrewarmEffect:
+	{
+		if (!write || command.effect >= EffectTable::GetSingleton()->size())
+			break;
 
-		if (info.weather == weather)
+		if (command.effect >= entry.prewarmed.size())
 		{
-			toggleEffect(info.effectName.c_str(), info.state);
-			info.isToggled = true;
-			m_weatherToggleCache.first = ws;
-
-			updateOrAddObject(m_weatherToggleCache.second, info);
+			entry.prewarmed.resize(EffectTable::GetSingleton()->size());
 		}
-		else if (info.isToggled)
-		{
-			toggleEffect(info.effectName.c_str(), !info.state);
-			info.isToggled = false;
 
-			removeById(m_weatherToggleCache.second, info);
-		}
+		if (entry.prewarmed[command.effect])
+			break;
+		entry.prewarmed[command.effect] = true;
 
-		for (auto& uniform : info.uniforms)
+		// enabling makes ReShade queue the load of an effect it skipped, disabling again in the same frame keeps it from rendering
+		for (const auto& technique : entry.getTechniques(command.effect))
 		{
-			setUniformValues(uniform);
+			if (!runtime->get_technique_state(technique))
+			{
+				runtime->set_technique_state(technique, true);
+				runtime->set_technique_state(technique, false);
+			}
 		}
 	}
-}
-
-void Manager::toggleEffectTime()
-{
-	const auto ui = RE::UI::GetSingleton();
-	const auto player = RE::PlayerCharacter::GetSingleton();
-	if (m_timeToggleInfo.empty() || !player || !RE::Calendar::GetSingleton() || !ui || ui->GameIsPaused())
-		return;
-
-	RE::TESForm* ws = player->GetWorldspace();
-	if (!ws)
+	break;
+	case CommandQueue::Type::ToggleReShade:
 	{
-		ws = player->GetParentCell();
+		if (!write)
+			break;
+
+		if (record)
+		{
+			journal->recordEffectsState(command.source, runtime->get_effects_state(), command.state);
+		}
+		runtime->set_effects_state(command.state);
 	}
+	break;
+	case CommandQueue::Type::SetUniform:
+	case CommandQueue::Type::RestoreUniform:
+	{
+		if (command.effect >= EffectTable::GetSingleton()->size())
+			break;
 
-	const auto it = m_timeToggleInfo.find(constructKey(ws));
-	const auto cachedWorldspace = m_timeToggleCache.first;
+		// handles differ between runtimes, so uniforms are always resolved by name
+		auto& uniform = entry.getUniform(command.effect, command.uniform);
+		const auto variable = uniform.variable;
+		if (variable.handle == 0)
+			break;
 
-	if (!ws || cachedWorldspace && cachedWorldspace->formID != ws->formID)
-	{
-		if (cachedWorldspace)
+		Journal::ValueType valueType = command.valueType;
+		std::uint8_t valueCount = command.valueCount;
+		std::uint32_t bits[4] = {};
+		std::copy_n(command.values, 4, bits);
+
+		if (command.type == CommandQueue::Type::RestoreUniform)
 		{
-			for (const auto& info : m_timeToggleCache.second)
+			if (command.baseline >= entry.baselines.size() || !entry.baselines[command.baseline].captured)
 			{
-				if (!ws || allowtoggleEffectTime(info, it))
+				if (write)
 				{
-					toggleEffect(info.effectName.c_str(), !info.state);
+					runtime->reset_uniform_value(variable); // never overridden on this runtime
+					uniform.current.captured = false;
 				}
+				break;
 			}
-			m_timeToggleCache.first = nullptr;
-			m_timeToggleCache.second.clear();
-		}
-		return;
-	}
 
-	if (it == m_timeToggleInfo.end())
-		return;
-
-	for (auto& timeInfo : it->second)
-	{
-		if (timeInfo.id == 0)
+			auto& baseline = entry.baselines[command.baseline];
+			baseline.captured = false;
+			valueType = baseline.valueType;
+			valueCount = baseline.valueCount;
+			std::copy_n(baseline.values, 4, bits);
+		}
+		else if (const auto handle = UniformBaseline::GetSingleton()->find(command.effect, command.uniform); handle != UniformBaseline::s_invalidHandle)
 		{
-			timeInfo.id = IDGenerator::getNextID();
+			// held by a rule, remember the value from before the first override
+			if (handle >= entry.baselines.size())
+			{
+				entry.baselines.resize(handle + 1);
+			}
+
+			auto& baseline = entry.baselines[handle];
+			if (!baseline.captured)
+			{
+				getUniformBits(variable, valueType, baseline.values, valueCount, runtime);
+				baseline.captured = true;
+				baseline.valueType = valueType;
+				baseline.valueCount = valueCount;
+				uniform.current = baseline;
+			}
 		}
 
-		const bool inRange = timeWithinRange(timeInfo.startTime, timeInfo.stopTime);
+		if (!write)
+			break;
+
+		// the journal's old value is the last one this runtime saw through the queue, never read back from ReShade
+		auto setAndRecord = [&]<typename T>(T* values) {
+			setUniformValue<T>(variable, values, valueCount, runtime);
 
-		if (inRange)
-		{
-			toggleEffect(timeInfo.effectName.c_str(), timeInfo.state);
-			timeInfo.isToggled = true;
-			m_timeToggleCache.first = ws;
+			if (record && journal->isEnabled())
+			{
+				const auto& current = uniform.current;
+				T oldValues[4] = {};
+				const bool oldKnown = current.captured && current.valueType == valueType;
+				for (std::uint8_t i = 0; oldKnown && i < std::min(current.valueCount, valueCount); i++)
+				{
+					if constexpr (std::is_same_v<T, bool>)
+						oldValues[i] = current.values[i] != 0;
+					else
+						oldValues[i] = std::bit_cast<T>(current.values[i]);
+				}
+				journal->recordUniform<T>(command.source, command.ruleID, effectName, command.uniform, oldKnown ? oldValues : nullptr, values, valueCount);
+			}
 
-			updateOrAddObject(m_timeToggleCache.second, timeInfo);
+			uniform.current = { true, valueType, valueCount };
+			std::copy_n(bits, 4, uniform.current.values);
+			};
+
+		switch (valueType)
+		{
+		case Journal::ValueType::Float:
+		{
+			float values[4] = {};
+			std::transform(bits, bits + 4, values, [](std::uint32_t value) { return std::bit_cast<float>(value); });
+			setAndRecord(values);
 		}
-		else if (!inRange && timeInfo.isToggled)
+		break;
+		case Journal::ValueType::Int:
 		{
-			toggleEffect(timeInfo.effectName.c_str(), !timeInfo.state);
-			timeInfo.isToggled = false;
-
-			removeById(m_timeToggleCache.second, timeInfo);
+			int values[4] = {};
+			std::transform(bits, bits + 4, values, [](std::uint32_t value) { return std::bit_cast<int>(value); });
+			setAndRecord(values);
 		}
-
-		for (auto& uniform : timeInfo.uniforms)
+		break;
+		case Journal::ValueType::UInt:
+		{
+			unsigned int values[4] = {};
+			std::copy(bits, bits + 4, values);
+			setAndRecord(values);
+		}
+		break;
+		case Journal::ValueType::Bool:
 		{
-			setUniformValues(uniform);
+			bool value = bits[0] != 0;
+			setAndRecord(&value);
+		}
+		break;
+		default:
+			break;
 		}
 	}
-
+	break;
+	}
 }
 
-void Manager::toggleEffectInterior(const bool isInterior)
+void Manager::releaseToggleCaches()
 {
-	const auto player = RE::PlayerCharacter::GetSingleton();
-	if (m_interiorToggleInfo.empty() || !player)
-		return;
+	const auto release = [this](ToggleCache& cache, Journal::Source source) {
+		for (const auto& entry : cache.getEntries())
+		{
+			toggleEffect(entry.effect, !entry.state, source, entry.ruleID);
+			releaseRuleUniforms(entry.ruleID);
+		}
+		cache.clear();
+		};
 
-	RE::TESForm* cell = player->GetParentCell();
-	const auto it = m_interiorToggleInfo.find(constructKey(cell));
-	const auto cachedCell = m_interiorToggleCache.first;
+	release(m_weatherToggleCache, Journal::Source::Weather);
+	release(m_timeToggleCache, Journal::Source::Time);
+	release(m_interiorToggleCache, Journal::Source::Interior);
 
-	if (!cell || !isInterior || cachedCell && cachedCell->formID != cell->formID)
+	// nothing is held anymore, the next evaluation of every pass has to run in full
+	for (auto& fingerprint : m_fingerprints)
 	{
-		if (cachedCell)
+		fingerprint.invalidate();
+	}
+
+	for (auto& [menu, infos] : m_menuToggleInfo)
+	{
+		for (auto& info : infos)
 		{
-			for (auto& info : m_interiorToggleCache.second)
+			if (!info.isToggled || info.effectID == EffectTable::s_invalidID)
+				continue;
+
+			if (--m_menuEffectUsage[info.effectID] == 0)
 			{
-				if (!isInterior || allowtoggleEffectInterior(info, it))
-				{
-					toggleEffect(info.effectName.c_str(), !info.state);
-				}
+				toggleEffect(info.effectID, !info.state, Journal::Source::Menu, info.id);
 			}
-			m_interiorToggleCache.first = nullptr;
-			m_interiorToggleCache.second.clear();
+			info.isToggled = false;
+			releaseRuleUniforms(info.id);
 		}
 	}
 
-	if (it == m_interiorToggleInfo.end())
-		return;
-
-	for (auto& info : it->second)
+	for (auto& info : m_ruleToggleInfo)
 	{
-		if (info.id == 0)
-		{
-			info.id = IDGenerator::getNextID();
-		}
+		if (!info.isToggled)
+			continue;
 
-		toggleEffect(info.effectName.c_str(), info.state);
-		updateOrAddObject(m_interiorToggleCache.second, info);
-
-		for (auto& uniform : info.uniforms)
-		{
-			setUniformValues(uniform);
-		}
+		toggleEffect(info.effectID, !info.state, Journal::Source::Rule, info.id);
+		info.isToggled = false;
+		releaseRuleUniforms(info.id);
 	}
-	m_interiorToggleCache.first = cell;
-
 }
 
-bool Manager::timeWithinRange(const float& startTime, const float& stopTime) const
+#pragma region TemplateTomfoolery
+// explicit metas so the runtime-only effectID stays out of the presets
+template<>
+struct glz::meta<MenuToggleInformation>
 {
-	const auto calendar = RE::Calendar::GetSingleton();
-	const std::uint32_t currentHour = static_cast<std::uint32_t>(calendar->GetHour());
-	const float currentTime = currentHour + (calendar->GetMinutes() / 100.f);
+	using T = MenuToggleInformation;
+	static constexpr auto value = object(
+		"effectName", &T::effectName,
+		"menuName", &T::menuName,
+		"state", &T::state,
+		"isToggled", &T::isToggled,
+		"timing", &T::timing,
+		"uniforms", &T::uniforms
+	);
+};
 
-	return currentTime >= startTime && currentTime <= stopTime;
-}
+template<>
+struct glz::meta<WeatherToggleInformation>
+{
+	using T = WeatherToggleInformation;
+	static constexpr auto value = object(
+		"effectName", &T::effectName,
+		"weather", &T::weather,
+		"state", &T::state,
+		"isToggled", &T::isToggled,
+		"id", &T::id,
+		"timing", &T::timing,
+		"uniforms", &T::uniforms
+	);
+};
 
-void Manager::toggleEffect(const char* effect, const bool state) const
+template<>
+struct glz::meta<InteriorToggleInformation>
 {
-	if (strcmp(effect, "EntireReShade") == 0)
-	{
-		toggleReshade(state);
-	}
-	else
-	{
-		s_pRuntime->enumerate_techniques(effect, [&state](reshade::api::effect_runtime* runtime, reshade::api::effect_technique technique) {
-			runtime->set_technique_state(technique, state); // True = enabled; False = disabled
-			});
-	}
-}
+	using T = InteriorToggleInformation;
+	static constexpr auto value = object(
+		"effectName", &T::effectName,
+		"state", &T::state,
+		"id", &T::id,
+		"timing", &T::timing,
+		"uniforms", &T::uniforms
+	);
+};
 
-void Manager::toggleReshade(const bool state) const
+template<>
+struct glz::meta<TimeToggleInformation>
 {
-	s_pRuntime->set_effects_state(state);
-}
+	using T = TimeToggleInformation;
+	static constexpr auto value = object(
+		"effectName", &T::effectName,
+		"windows", &T::windows,
+		"state", &T::state,
+		"isToggled", &T::isToggled,
+		"id", &T::id,
+		"timing", &T::timing,
+		"days", &T::days,
+		"months", &T::months,
+		"seasons", &T::seasons,
+		"uniforms", &T::uniforms,
+		"startTime", &T::startTime,
+		"stopTime", &T::stopTime
+	);
+};
 
-template <typename T>
-void Manager::removeById(std::vector<T>& vec, const T& objToRemove)
-{
-	vec.erase(
-		std::remove_if(
-		vec.begin(),
-		vec.end(),
-		[&objToRemove](const T& existing) {
-			return existing.id == objToRemove.id;
-		}),
-		vec.end());
-}
-
-template <typename T, typename V>
-void Manager::updateOrAddObject(V& container, const T& objToUpdate)
-{
-	auto existingIt = std::find_if(
-		container.begin(),
-		container.end(),
-		[&objToUpdate](const T& existing) {
-			return existing.id == objToUpdate.id;
-		});
+template<>
+struct glz::meta<RuleToggleInformation>
+{
+	using T = RuleToggleInformation;
+	static constexpr auto value = object(
+		"effectName", &T::effectName,
+		"state", &T::state,
+		"startHour", &T::startHour,
+		"stopHour", &T::stopHour,
+		"location", &T::location,
+		"menu", &T::menu,
+		"weathers", &T::weathers,
+		"isToggled", &T::isToggled,
+		"id", &T::id,
+		"timing", &T::timing,
+		"uniforms", &T::uniforms
+	);
+};
 
-	if (existingIt != container.end())
-	{
-		*existingIt = objToUpdate;
-	}
-	else
-	{
-		container.emplace_back(objToUpdate);
-	}
-}
+template<>
+struct glz::meta<ToggleTiming>
+{
+	using T = ToggleTiming;
+	static constexpr auto value = object(
+		"debounceMs", &T::debounceMs,
+		"minDurationMs", &T::minDurationMs
+	);
+};
 
-#pragma region TemplateTomfoolery
 template<>
 struct glz::meta<UniformInfo>
 {
@@ -578,7 +1526,34 @@ struct glz::meta<UniformInfo>
 		"IntValues", &T::intValues,
 		"FloatValues", &T::floatValues,
 		"UIntValues", &T::uintValues,
-		"Prefetched", &T::prefetched
+		"Prefetched", &T::prefetched,
+		"Keyframes", &T::keyframes,
+		"Interpolation", &T::interpolation,
+		"Binding", &T::binding
+	);
+};
+
+template<>
+struct glz::meta<UniformBinding>
+{
+	using T = UniformBinding;
+	static constexpr auto value = object(
+		"Source", &T::source,
+		"Global", &T::global,
+		"Scale", &T::scale,
+		"Offset", &T::offset,
+		"Min", &T::min,
+		"Max", &T::max
+	);
+};
+
+template<>
+struct glz::meta<Keyframe>
+{
+	using T = Keyframe;
+	static constexpr auto value = object(
+		"Hour", &T::hour,
+		"Values", &T::values
 	);
 };
 
@@ -699,6 +1674,10 @@ bool Manager::deserializeVector(const std::string& key, const glz::json_t& json,
 			return false;
 		}
 	}
+	else if (isOptionalKey(key))
+	{
+		vec.clear();
+	}
 	else
 	{
 		SKSE::log::error("Key '{}' not found in JSON.", key);
@@ -777,25 +1756,31 @@ bool Manager::deserializeArbitraryData(const std::string& buf, Args&... args)
 }
 
 template <typename T>
-void Manager::setUniformValue(const reshade::api::effect_uniform_variable& uniformVariable, T* value, size_t count)
+void Manager::setUniformValue(const reshade::api::effect_uniform_variable& uniformVariable, T* value, size_t count, reshade::api::effect_runtime* runtime)
 {
 	assert(count > 0 && count <= 4);
 
+	if (!runtime)
+	{
+		RuntimeRegistry::GetSingleton()->withPrimary([&](reshade::api::effect_runtime* primary) { setUniformValue(uniformVariable, value, count, primary); });
+		return;
+	}
+
 	if constexpr (std::is_same<T, float>::value)
 	{
-		s_pRuntime->set_uniform_value_float(uniformVariable, value, count);
+		runtime->set_uniform_value_float(uniformVariable, value, count);
 	}
 	else if constexpr (std::is_same<T, int>::value)
 	{
-		s_pRuntime->set_uniform_value_int(uniformVariable, value, count);
+		runtime->set_uniform_value_int(uniformVariable, value, count);
 	}
 	else if constexpr (std::is_same<T, unsigned int>::value)
 	{
-		s_pRuntime->set_uniform_value_uint(uniformVariable, value, count);
+		runtime->set_uniform_value_uint(uniformVariable, value, count);
 	}
 	else if constexpr (std::is_same<T, bool>::value)
 	{
-		s_pRuntime->set_uniform_value_bool(uniformVariable, value, count);
+		runtime->set_uniform_value_bool(uniformVariable, value, count);
 	}
 	else
 	{
@@ -804,25 +1789,31 @@ void Manager::setUniformValue(const reshade::api::effect_uniform_variable& unifo
 }
 
 template <typename T>
-void Manager::getUniformValue(const reshade::api::effect_uniform_variable& uniformVariable, T* value, size_t count)
+void Manager::getUniformValue(const reshade::api::effect_uniform_variable& uniformVariable, T* value, size_t count, reshade::api::effect_runtime* runtime)
 {
 	assert(count > 0 && count <= 4);
 
+	if (!runtime)
+	{
+		RuntimeRegistry::GetSingleton()->withPrimary([&](reshade::api::effect_runtime* primary) { getUniformValue(uniformVariable, value, count, primary); });
+		return;
+	}
+
 	if constexpr (std::is_same<T, float>::value)
 	{
-		s_pRuntime->get_uniform_value_float(uniformVariable, value, count);
+		runtime->get_uniform_value_float(uniformVariable, value, count);
 	}
 	else if constexpr (std::is_same<T, int>::value)
 	{
-		s_pRuntime->get_uniform_value_int(uniformVariable, value, count);
+		runtime->get_uniform_value_int(uniformVariable, value, count);
 	}
 	else if constexpr (std::is_same<T, unsigned int>::value)
 	{
-		s_pRuntime->get_uniform_value_uint(uniformVariable, value, count);
+		runtime->get_uniform_value_uint(uniformVariable, value, count);
 	}
 	else if constexpr (std::is_same<T, bool>::value)
 	{
-		s_pRuntime->get_uniform_value_bool(uniformVariable, value, count);
+		runtime->get_uniform_value_bool(uniformVariable, value, count);
 	}
 	else
 	{
@@ -830,19 +1821,41 @@ void Manager::getUniformValue(const reshade::api::effect_uniform_variable& unifo
 	}
 }
 
-template void Manager::getUniformValue<bool>(const reshade::api::effect_uniform_variable& uniformVariable, bool* values, size_t count);
-template void Manager::setUniformValue<bool>(const reshade::api::effect_uniform_variable& uniformVariable, bool* values, size_t count);
+void Manager::getUniformBits(const reshade::api::effect_uniform_variable& uniformVariable, Journal::ValueType valueType, std::uint32_t* bits, size_t count, reshade::api::effect_runtime* runtime)
+{
+	auto read = [&]<typename T>() {
+		T values[4] = {};
+		getUniformValue<T>(uniformVariable, values, count, runtime);
+		for (size_t i = 0; i < count; i++)
+		{
+			if constexpr (std::is_same_v<T, bool>)
+				bits[i] = values[i];
+			else
+				bits[i] = std::bit_cast<std::uint32_t>(values[i]);
+		}
+		};
+
+	switch (valueType)
+	{
+	case Journal::ValueType::Float: read.template operator()<float>(); break;
+	case Journal::ValueType::Int: read.template operator()<int>(); break;
+	case Journal::ValueType::UInt: read.template operator()<unsigned int>(); break;
+	case Journal::ValueType::Bool: read.template operator()<bool>(); break;
+	default: break;
+	}
+}
 
-template void Manager::getUniformValue<float>(const reshade::api::effect_uniform_variable& uniformVariable, float* values, size_t count);
-template void Manager::setUniformValue<float>(const reshade::api::effect_uniform_variable& uniformVariable, float* values, size_t count);
+template void Manager::getUniformValue<bool>(const reshade::api::effect_uniform_variable& uniformVariable, bool* values, size_t count, reshade::api::effect_runtime* runtime);
+template void Manager::setUniformValue<bool>(const reshade::api::effect_uniform_variable& uniformVariable, bool* values, size_t count, reshade::api::effect_runtime* runtime);
 
-template void Manager::getUniformValue<int>(const reshade::api::effect_uniform_variable& uniformVariable, int* values, size_t count);
-template void Manager::setUniformValue<int>(const reshade::api::effect_uniform_variable& uniformVariable, int* values, size_t count);
+template void Manager::getUniformValue<float>(const reshade::api::effect_uniform_variable& uniformVariable, float* values, size_t count, reshade::api::effect_runtime* runtime);
+template void Manager::setUniformValue<float>(const reshade::api::effect_uniform_variable& uniformVariable, float* values, size_t count, reshade::api::effect_runtime* runtime);
 
-template void Manager::getUniformValue<unsigned int>(const reshade::api::effect_uniform_variable& uniformVariable, unsigned int* values, size_t count);
-template void Manager::setUniformValue<unsigned int>(const reshade::api::effect_uniform_variable& uniformVariable, unsigned int* values, size_t count);
+template void Manager::getUniformValue<int>(const reshade::api::effect_uniform_variable& uniformVariable, int* values, size_t count, reshade::api::effect_runtime* runtime);
+template void Manager::setUniformValue<int>(const reshade::api::effect_uniform_variable& uniformVariable, int* values, size_t count, reshade::api::effect_runtime* runtime);
 
-template void Manager::removeById<InteriorToggleInformation>(std::vector<InteriorToggleInformation>& vec, const InteriorToggleInformation& objToRemove);
+template void Manager::getUniformValue<unsigned int>(const reshade::api::effect_uniform_variable& uniformVariable, unsigned int* values, size_t count, reshade::api::effect_runtime* runtime);
+template void Manager::setUniformValue<unsigned int>(const reshade::api::effect_uniform_variable& uniformVariable, unsigned int* values, size_t count, reshade::api::effect_runtime* runtime);
 
 #pragma endregion
 
@@ -851,68 +1864,80 @@ std::vector<UniformInfo> Manager::enumerateUniformNames(const std::string& effec
 {
 	std::vector<UniformInfo> uniforms;
 
-	s_pRuntime->enumerate_uniform_variables(effectName.c_str(), [&](reshade::api::effect_runtime* runtime, reshade::api::effect_uniform_variable uniform) {
-		using format = reshade::api::format;
+	// held for the whole walk, the reads inside go straight to the runtime it hands out
+	RuntimeRegistry::GetSingleton()->withPrimary([&](reshade::api::effect_runtime* primary) {
+		primary->enumerate_uniform_variables(effectName.c_str(), [&](reshade::api::effect_runtime* runtime, reshade::api::effect_uniform_variable uniform) {
+			using format = reshade::api::format;
 
-		char name[128] = "";
-		runtime->get_uniform_variable_name(uniform, name);
+			char name[128] = "";
+			runtime->get_uniform_variable_name(uniform, name);
 
-		UniformInfo uniformInfo(name, uniform);
+			UniformInfo uniformInfo(name, uniform);
 
-		format baseType = format::unknown;
-		runtime->get_uniform_variable_type(uniform, &baseType);
+			format baseType = format::unknown;
+			runtime->get_uniform_variable_type(uniform, &baseType);
 
-		switch (baseType)
-		{
-		case format::r32_float:
-		{
-			float values[4] = { 0.0f };
-			int numElements = std::min(4, getUniformDimension(uniform));
-			getUniformValue(uniform, values, numElements);
-			uniformInfo.setFloatValues(values, numElements);
-		}
-		break;
-		case format::r32_sint:
-		{
-			int values[4] = { 0 };
-			int numElements = std::min(4, getUniformDimension(uniform));
-			getUniformValue(uniform, values, numElements);
-			uniformInfo.setIntValues(values, numElements);
-		}
-		break;
-		case format::r32_uint:
-		{
-			unsigned int values[4] = { 0 };
-			int numElements = std::min(4, getUniformDimension(uniform));
-			getUniformValue(uniform, values, numElements);
-			uniformInfo.setUIntValues(values, numElements);
-		}
-		break;
-		case format::r32_typeless:
-		{
-			bool value = false;
-			getUniformValue(uniform, &value, 1);
-			uniformInfo.setBoolValues(static_cast<uint8_t>(value));
-		}
-		break;
-		default:
+			switch (baseType)
+			{
+			case format::r32_float:
+			{
+				float values[4] = { 0.0f };
+				int numElements = std::min(4, getUniformDimension(uniform, runtime));
+				getUniformValue(uniform, values, numElements, runtime);
+				uniformInfo.setFloatValues(values, numElements);
+			}
 			break;
-		}
+			case format::r32_sint:
+			{
+				int values[4] = { 0 };
+				int numElements = std::min(4, getUniformDimension(uniform, runtime));
+				getUniformValue(uniform, values, numElements, runtime);
+				uniformInfo.setIntValues(values, numElements);
+			}
+			break;
+			case format::r32_uint:
+			{
+				unsigned int values[4] = { 0 };
+				int numElements = std::min(4, getUniformDimension(uniform, runtime));
+				getUniformValue(uniform, values, numElements, runtime);
+				uniformInfo.setUIntValues(values, numElements);
+			}
+			break;
+			case format::r32_typeless:
+			{
+				bool value = false;
+				getUniformValue(uniform, &value, 1, runtime);
+				uniformInfo.setBoolValues(static_cast<uint8_t>(value));
+			}
+			break;
+			default:
+				break;
+			}
 
-		uniforms.emplace_back(std::move(uniformInfo));
+			uniforms.emplace_back(std::move(uniformInfo));
+			});
 		});
 
 	return uniforms;
 }
 
-int Manager::getUniformDimension(const reshade::api::effect_uniform_variable& uniformVariable) const
+int Manager::getUniformDimension(const reshade::api::effect_uniform_variable& uniformVariable, reshade::api::effect_runtime* runtime) const
 {
 
 	using format = reshade::api::format;
 	reshade::api::format baseType;
 	uint32_t rows = 0, columns = 0, arrayLength = 0;
 
-	s_pRuntime->get_uniform_variable_type(uniformVariable, &baseType, &rows, &columns, &arrayLength);
+	if (runtime)
+	{
+		runtime->get_uniform_variable_type(uniformVariable, &baseType, &rows, &columns, &arrayLength);
+	}
+	else
+	{
+		RuntimeRegistry::GetSingleton()->withPrimary([&](reshade::api::effect_runtime* primary) {
+			primary->get_uniform_variable_type(uniformVariable, &baseType, &rows, &columns, &arrayLength);
+			});
+	}
 
 	// Determine the dimension based on the base type and dimensions
 	if (arrayLength > 0)
@@ -942,22 +1967,48 @@ int Manager::getUniformDimension(const reshade::api::effect_uniform_variable& un
 	return 1;
 }
 
-bool Manager::effectExists(const char* effect)
+reshade::api::format Manager::getUniformType(const reshade::api::effect_uniform_variable& uniformVariable) const
 {
-	bool found = false;
+	reshade::api::format baseType = reshade::api::format::unknown;
 
-	s_pRuntime->enumerate_techniques(nullptr, [&](reshade::api::effect_runtime* runtime, reshade::api::effect_technique technique) {
-		if (found)
-			return;
+	RuntimeRegistry::GetSingleton()->withPrimary([&](reshade::api::effect_runtime* primary) {
+		primary->get_uniform_variable_type(uniformVariable, &baseType);
+		});
 
-		char nameBuffer[128] = "";
-		runtime->get_technique_effect_name(technique, nameBuffer);
+	return baseType;
+}
 
-		if (strcmp(effect, nameBuffer) == 0)
-		{
-			found = true;
-		}
+bool Manager::effectExists(const char* effect) const
+{
+	const auto id = EffectTable::GetSingleton()->find(effect);
+
+	std::shared_lock lock(m_effectIndexLock);
+	return id < m_loadedEffects.size() && m_loadedEffects[id];
+}
+
+void Manager::rebuildEffectIndex()
+{
+	const auto table = EffectTable::GetSingleton();
+	std::vector<std::uint8_t> loaded;
+
+	// the union over every runtime, so a reload of one eye doesn't hide what the other still has
+	RuntimeRegistry::GetSingleton()->forEach([&](RuntimeRegistry::Entry& entry) {
+		entry.runtime->enumerate_techniques(nullptr, [&](reshade::api::effect_runtime* runtime, reshade::api::effect_technique technique) {
+			char nameBuffer[128] = "";
+			runtime->get_technique_effect_name(technique, nameBuffer);
+
+			const auto id = table->intern(nameBuffer);
+			if (id == EffectTable::s_invalidID)
+				return;
+
+			if (id >= loaded.size())
+			{
+				loaded.resize(id + 1, false);
+			}
+			loaded[id] = true;
+			});
 		});
 
-	return found;
+	std::unique_lock lock(m_effectIndexLock);
+	m_loadedEffects = std::move(loaded);
 }
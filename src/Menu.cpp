@@ -1,9 +1,30 @@
 #include "Menu.h"
 #include "Manager.h"
 #include "Utils.h"
+#include "Profiler.h"
+#include "FrameGovernor.h"
+#include "EffectPrewarmer.h"
+#include "ToggleDebouncer.h"
+#include "CompilePool.h"
+
+namespace
+{
+	// the benchmarks run off the render thread, the overlay picks up their results once they're done
+	template <typename T>
+	bool pollTask(std::future<T>& task, T& result)
+	{
+		if (!task.valid() || task.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+			return false;
+
+		result = task.get();
+		return true;
+	}
+}
 
 void Menu::SettingsMenu()
 {
+	PROFILE_ZONE(Profiler::Zone::SettingsMenu);
+
 	if (ImGui::Button("Configure ReShade Effect Toggler"))
 		m_openSettingsMenu = true;
 
@@ -41,6 +62,16 @@ void Menu::SettingsMenu()
 				currentTab = 4;
 				ImGui::EndTabItem();
 			}
+			if (ImGui::BeginTabItem("Rule Settings"))
+			{
+				currentTab = 5;
+				ImGui::EndTabItem();
+			}
+			if (ImGui::BeginTabItem("Performance"))
+			{
+				currentTab = 6;
+				ImGui::EndTabItem();
+			}
 		}
 
 		ImGuiID dockspaceId = ImGui::GetID("SettingsDockspace");
@@ -53,15 +84,62 @@ void Menu::SettingsMenu()
 		case 2: SpawnTimeSettings(dockspaceId); break;
 		case 3: SpawnInteriorSettings(dockspaceId); break;
 		case 4: SpawnWeatherSettings(dockspaceId); break;
+		case 5: SpawnRuleSettings(dockspaceId); break;
+		case 6: SpawnPerformancePage(dockspaceId); break;
 		}
 	}
 }
 
+bool Menu::loadPreset(const std::string& preset)
+{
+	const auto start = std::chrono::high_resolution_clock::now();
+	const bool success = Manager::GetSingleton()->parseJSONPreset(preset);
+	const auto end = std::chrono::high_resolution_clock::now();
+	std::chrono::duration<double, std::milli> duration = end - start;
+
+	if (success)
+	{
+		Manager::GetSingleton()->setLastPreset(preset);
+		Manager::GetSingleton()->serializeINI();
+	}
+
+	std::scoped_lock lock(m_loadedPresetLock);
+	m_loadedPreset = LoadedPreset{ preset, success, duration.count() };
+	return success;
+}
+
+void Menu::takeLoadedPreset()
+{
+	std::optional<LoadedPreset> loaded;
+	{
+		std::scoped_lock lock(m_loadedPresetLock);
+		loaded.swap(m_loadedPreset);
+	}
+
+	if (!loaded)
+		return;
+
+	if (!loaded->success)
+	{
+		m_lastMessage = "Failed to load preset: '" + loaded->name + "'.";
+		m_lastMessageColor = ImVec4(1.0f, 0.0f, 0.0f, 1.0f);
+	}
+	else
+	{
+		m_selectedPreset = loaded->name;
+
+		m_lastMessage = "Successfully loaded preset: '" + loaded->name + "'! Took: " + std::to_string(loaded->duration) + "ms";
+		m_lastMessageColor = ImVec4(0.0f, 1.0f, 0.0f, 1.0f);
+	}
+}
+
 void Menu::SpawnMainPage(ImGuiID dockspace_id)
 {
 	ImGui::SetNextWindowDockID(dockspace_id, ImGuiCond_Always);
 	ImGui::Begin("Main", nullptr, ImGuiWindowFlags_NoCollapse);
 
+	takeLoadedPreset();
+
 	CreateCombo("Select Preset", m_selectedPreset, m_presets, ImGuiComboFlags_None);
 	ImGui::SameLine();
 	if (ImGui::Button("Reload Preset List"))
@@ -75,24 +153,8 @@ void Menu::SpawnMainPage(ImGuiID dockspace_id)
 		const std::string selectedPresetPath = Manager::GetSingleton()->getPresetPath(m_selectedPreset);
 		if (std::filesystem::exists(selectedPresetPath))
 		{
-			const auto start = std::chrono::high_resolution_clock::now();
-			const bool success = Manager::GetSingleton()->parseJSONPreset(m_selectedPreset);
-			const auto end = std::chrono::high_resolution_clock::now();
-			std::chrono::duration<double, std::milli> duration = end - start;
-
-			if (!success)
-			{
-				m_lastMessage = "Failed to load preset: '" + m_selectedPreset + "'.";
-				m_lastMessageColor = ImVec4(1.0f, 0.0f, 0.0f, 1.0f);
-			}
-			else
-			{
-				Manager::GetSingleton()->setLastPreset(m_selectedPreset);
-				Manager::GetSingleton()->serializeINI();
-
-				m_lastMessage = "Successfully loaded preset: '" + m_selectedPreset + "'! Took: " + std::to_string(duration.count()) + "ms";
-				m_lastMessageColor = ImVec4(0.0f, 1.0f, 0.0f, 1.0f);
-			}
+			loadPreset(m_selectedPreset);
+			takeLoadedPreset();
 		}
 		else
 		{
@@ -129,6 +191,7 @@ void Menu::SpawnMenuSettings(ImGuiID dockspace_id)
 	std::map<std::string, std::vector<MenuToggleInformation>> infoList = Manager::GetSingleton()->getMenuToggleInfo();
 	std::map<std::string, std::vector<MenuToggleInformation>> updatedInfoList = infoList;
 	static char inputBuffer[256] = "";
+	bool listChanged = false;
 	ImGui::InputTextWithHint("##Search", "Search Menus...", inputBuffer, sizeof(inputBuffer));
 
 	int headerId = -1;
@@ -144,9 +207,10 @@ void Menu::SpawnMenuSettings(ImGuiID dockspace_id)
 
 		if (ImGui::CollapsingHeader((menuName + "##" + headerUniqueId + "##Header").c_str(), ImGuiTreeNodeFlags_AllowOverlap | ImGuiTreeNodeFlags_AllowItemOverlap))
 		{
-			ImGui::BeginTable(("EffectsTable##" + headerUniqueId).c_str(), 4, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg);
+			ImGui::BeginTable(("EffectsTable##" + headerUniqueId).c_str(), 5, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg);
 			ImGui::TableSetupColumn(("Effect##" + headerUniqueId).c_str());
 			ImGui::TableSetupColumn(("State##" + headerUniqueId).c_str());
+			ImGui::TableSetupColumn(("Timing##" + headerUniqueId).c_str());
 			ImGui::TableSetupColumn(("Actions##" + headerUniqueId).c_str());
 			ImGui::TableSetupColumn(("MenuName##" + headerUniqueId).c_str());
 			ImGui::TableHeadersRow();
@@ -175,6 +239,11 @@ void Menu::SpawnMenuSettings(ImGuiID dockspace_id)
 					valueChanged = true;
 				}
 				ImGui::TableNextColumn();
+				if (TimingInput("Timing##" + headerUniqueId + std::to_string(i), info.timing))
+				{
+					valueChanged = true;
+				}
+				ImGui::TableNextColumn();
 				if (ImGui::Button(removeId.c_str()))
 				{
 					// Remove effect
@@ -191,6 +260,7 @@ void Menu::SpawnMenuSettings(ImGuiID dockspace_id)
 						updatedInfoList.erase(menuName);
 					}
 
+					listChanged = true;
 					globalIndex--;
 					continue;
 				}
@@ -210,12 +280,16 @@ void Menu::SpawnMenuSettings(ImGuiID dockspace_id)
 					info.effectName = currentEffectName;
 					info.state = currentEffectState;
 					updatedInfoList[menuName].at(i) = info;
+					listChanged = true;
 				}
 
 				if (m_editingEffectIndex == globalIndex)
 				{
 					auto& targetUniforms = updatedInfoList[menuName].at(i).uniforms;
-					HandleEffectEditing(targetUniforms, m_currentEditingEffect, m_editingEffectIndex);
+					if (HandleEffectEditing(targetUniforms, m_currentEditingEffect, m_editingEffectIndex))
+					{
+						listChanged = true;
+					}
 				}
 
 			}
@@ -224,8 +298,11 @@ void Menu::SpawnMenuSettings(ImGuiID dockspace_id)
 		}
 	}
 
-
-	Manager::GetSingleton()->setMenuToggleInfo(updatedInfoList);
+	// only hand the list back when something actually changed
+	if (listChanged)
+	{
+		Manager::GetSingleton()->setMenuToggleInfo(updatedInfoList);
+	}
 
 	ImGui::SeparatorText("Add New");
 	// Add new effect
@@ -305,6 +382,7 @@ void Menu::SpawnTimeSettings(ImGuiID dockspace_id)
 	std::map<std::string, std::vector<TimeToggleInformation>> infoList = Manager::GetSingleton()->getTimeToggleInfo();
 	std::map<std::string, std::vector<TimeToggleInformation>> updatedInfoList = infoList;
 	static char inputBuffer[256] = "";
+	bool listChanged = false;
 	ImGui::InputTextWithHint("##Search", "Search Cell...", inputBuffer, sizeof(inputBuffer));
 
 	int headerId = -1;
@@ -320,11 +398,12 @@ void Menu::SpawnTimeSettings(ImGuiID dockspace_id)
 
 		if (ImGui::CollapsingHeader((cellName + "##" + headerUniqueId + "##Header").c_str(), ImGuiTreeNodeFlags_AllowOverlap | ImGuiTreeNodeFlags_AllowItemOverlap))
 		{
-			ImGui::BeginTable(("EffectsTable##" + headerUniqueId).c_str(), 6, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg);
+			ImGui::BeginTable(("EffectsTable##" + headerUniqueId).c_str(), 7, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg);
 			ImGui::TableSetupColumn(("Effect##" + headerUniqueId).c_str());
 			ImGui::TableSetupColumn(("State##" + headerUniqueId).c_str());
-			ImGui::TableSetupColumn(("StartTime##" + headerUniqueId).c_str());
-			ImGui::TableSetupColumn(("StopTime##" + headerUniqueId).c_str());
+			ImGui::TableSetupColumn(("Timing##" + headerUniqueId).c_str());
+			ImGui::TableSetupColumn(("Time Windows##" + headerUniqueId).c_str());
+			ImGui::TableSetupColumn(("Dates##" + headerUniqueId).c_str());
 			ImGui::TableSetupColumn(("Actions##" + headerUniqueId).c_str());
 			ImGui::TableSetupColumn(("Cell##" + headerUniqueId).c_str());
 			ImGui::TableHeadersRow();
@@ -336,79 +415,54 @@ void Menu::SpawnTimeSettings(ImGuiID dockspace_id)
 
 				std::string effectComboId = "Effect##" + headerUniqueId + std::to_string(i);
 				std::string effectStateId = "State##" + headerUniqueId + std::to_string(i);
-				std::string startTimeId = "StartTime##" + headerUniqueId + std::to_string(i);
-				std::string stopTimeId = "StopTime##" + headerUniqueId + std::to_string(i);
+				std::string windowId = "Window##" + headerUniqueId + std::to_string(i);
+				std::string dateId = "Date##" + headerUniqueId + std::to_string(i);
 				std::string removeId = "RemoveEffect##" + headerUniqueId + std::to_string(i);
 				std::string editId = "EditEffect##" + headerUniqueId + std::to_string(i);
 
 				std::string currentEffectName = info.effectName;
-				float currentStartTime = info.startTime;
-				float currentStopTime = info.stopTime;
+				std::vector<GameTime::Window> currentWindows = info.windows;
 				bool currentEffectState = info.state;
 
-				int startHours = static_cast<int>(currentStartTime);
-				int startMinutes = static_cast<int>((currentStartTime - startHours) * 100);
-				int stopHours = static_cast<int>(currentStopTime);
-				int stopMinutes = static_cast<int>((currentStopTime - stopHours) * 100);
-
-				static char startHourStr[3] = "00";
-				static char startMinuteStr[3] = "00";
-				static char stopHourStr[3] = "00";
-				static char stopMinuteStr[3] = "00";
-
-				snprintf(startHourStr, sizeof(startHourStr), "%02d", startHours);
-				snprintf(startMinuteStr, sizeof(startMinuteStr), "%02d", startMinutes);
-				snprintf(stopHourStr, sizeof(stopHourStr), "%02d", stopHours);
-				snprintf(stopMinuteStr, sizeof(stopMinuteStr), "%02d", stopMinutes);
-
 				ImGui::TableNextRow();
 				ImGui::TableNextColumn();
 				if (CreateCombo(effectComboId.c_str(), currentEffectName, m_effects, ImGuiComboFlags_None)) { valueChanged = true; }
 				ImGui::TableNextColumn();
 				if (ImGui::Checkbox(effectStateId.c_str(), &currentEffectState)) { valueChanged = true; }
-
-				// Start time
 				ImGui::TableNextColumn();
-				ImGui::PushItemWidth(35);
-				if (ImGui::InputText(("##StartHours" + startTimeId).c_str(), startHourStr, sizeof(startHourStr), ImGuiInputTextFlags_CharsDecimal)) { valueChanged = true; }
-				ClampInputValue(startHourStr, 23);
-				if (strcmp(startHourStr, "00") == 0 && strlen(startHourStr) == 0) strcpy(startHourStr, "0");
-				ImGui::SameLine();
-				ImGui::Text(":");
-				ImGui::SameLine();
-				if (ImGui::InputText(("##StartMinutes" + startTimeId).c_str(), startMinuteStr, sizeof(startMinuteStr), ImGuiInputTextFlags_CharsDecimal)) { valueChanged = true; }
-				ClampInputValue(startMinuteStr, 59);
-				if (strcmp(startMinuteStr, "00") == 0 && strlen(startMinuteStr) == 0) strcpy(startMinuteStr, "0");
-				ImGui::PopItemWidth();
-
-				// Stop Time
+				if (TimingInput("Timing##" + headerUniqueId + std::to_string(i), info.timing)) { valueChanged = true; }
+
+				// Windows, a start after the stop wraps past midnight
 				ImGui::TableNextColumn();
-				ImGui::PushItemWidth(35);
-				if (ImGui::InputText(("##StopHours" + stopTimeId).c_str(), stopHourStr, sizeof(stopHourStr), ImGuiInputTextFlags_CharsDecimal)) { valueChanged = true; }
-				ClampInputValue(stopHourStr, 23);
-				if (strcmp(stopHourStr, "00") == 0 && strlen(stopHourStr) == 0) strcpy(stopHourStr, "0");
-				ImGui::SameLine();
-				ImGui::Text(":");
-				ImGui::SameLine();
-				if (ImGui::InputText(("##StopMinutes" + stopTimeId).c_str(), stopMinuteStr, sizeof(stopMinuteStr), ImGuiInputTextFlags_CharsDecimal)) { valueChanged = true; }
-				ClampInputValue(stopMinuteStr, 59);
-				if (strcmp(stopMinuteStr, "00") == 0 && strlen(stopMinuteStr) == 0) strcpy(stopMinuteStr, "0");
-				ImGui::PopItemWidth();
-
-				// Convert baby
-				startHours = strlen(startHourStr) > 0 ? std::stoi(startHourStr) : 0;
-				startMinutes = strlen(startMinuteStr) > 0 ? std::stoi(startMinuteStr) : 0;
-				stopHours = strlen(stopHourStr) > 0 ? std::stoi(stopHourStr) : 0;
-				stopMinutes = strlen(stopMinuteStr) > 0 ? std::stoi(stopMinuteStr) : 0;
-
-				currentStartTime = startHours + (startMinutes / 100.0f);
-				currentStopTime = stopHours + (stopMinutes / 100.0f);
-
-				if (currentStartTime > currentStopTime)
+				for (size_t w = 0; w < currentWindows.size(); w++)
 				{
-					ImGui::TextColored(ImVec4(1, 0, 0, 1), "Invalid Time Range");
+					const std::string id = windowId + "_" + std::to_string(w);
+					if (TimeInput("Start" + id, currentWindows[w].start)) { valueChanged = true; }
+					ImGui::SameLine();
+					ImGui::Text("-");
+					ImGui::SameLine();
+					if (TimeInput("Stop" + id, currentWindows[w].stop)) { valueChanged = true; }
+
+					if (currentWindows.size() > 1)
+					{
+						ImGui::SameLine();
+						if (ImGui::SmallButton(("x##Remove" + id).c_str()))
+						{
+							currentWindows.erase(currentWindows.begin() + w);
+							valueChanged = true;
+							break;
+						}
+					}
+				}
+				if (ImGui::SmallButton(("Add Window##" + windowId).c_str()))
+				{
+					currentWindows.push_back({});
+					valueChanged = true;
 				}
 
+				ImGui::TableNextColumn();
+				if (DateConditions(dateId, info)) { valueChanged = true; }
+
 				ImGui::TableNextColumn();
 				if (ImGui::Button(removeId.c_str()))
 				{
@@ -428,6 +482,7 @@ void Menu::SpawnTimeSettings(ImGuiID dockspace_id)
 						updatedInfoList.erase(cellName);
 					}
 
+					listChanged = true;
 					globalIndex--;
 					continue;
 				}
@@ -443,24 +498,31 @@ void Menu::SpawnTimeSettings(ImGuiID dockspace_id)
 				if (valueChanged)
 				{
 					info.effectName = currentEffectName;
-					info.startTime = currentStartTime;
-					info.stopTime = currentStopTime;
+					info.windows = currentWindows;
 					info.state = currentEffectState;
 
 					updatedInfoList[cellName].at(i) = info;
+					listChanged = true;
 				}
 
 				if (m_editingEffectIndex == globalIndex)
 				{
 					auto& targetUniforms = updatedInfoList[cellName].at(i).uniforms;
-					HandleEffectEditing(targetUniforms, m_currentEditingEffect, m_editingEffectIndex);
+					if (HandleEffectEditing(targetUniforms, m_currentEditingEffect, m_editingEffectIndex))
+					{
+						listChanged = true;
+					}
 				}
 			}
 			ImGui::EndTable();
 		}
 	}
 
-	Manager::GetSingleton()->setTimeToggleInfo(updatedInfoList);
+	// only recompile and wake the pass when something actually changed
+	if (listChanged)
+	{
+		Manager::GetSingleton()->setTimeToggleInfo(updatedInfoList);
+	}
 
 	ImGui::SeparatorText("Add New");
 
@@ -483,6 +545,7 @@ void Menu::SpawnInteriorSettings(ImGuiID dockspace_id)
 	std::map<std::string, std::vector<InteriorToggleInformation>> infoList = Manager::GetSingleton()->getInteriorToggleInfo();
 	std::map<std::string, std::vector<InteriorToggleInformation>> updatedInfoList = infoList; // Start with existing info
 	static char inputBuffer[256] = "";
+	bool listChanged = false;
 	ImGui::InputTextWithHint("##Search", "Search Interior Cell...", inputBuffer, sizeof(inputBuffer));
 
 	int headerId = -1;
@@ -498,9 +561,10 @@ void Menu::SpawnInteriorSettings(ImGuiID dockspace_id)
 
 		if (ImGui::CollapsingHeader((cellName + "##" + headerUniqueId + "##Header").c_str(), ImGuiTreeNodeFlags_AllowOverlap | ImGuiTreeNodeFlags_AllowItemOverlap))
 		{
-			ImGui::BeginTable(("EffectsTable##" + headerUniqueId).c_str(), 4, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg);
+			ImGui::BeginTable(("EffectsTable##" + headerUniqueId).c_str(), 5, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg);
 			ImGui::TableSetupColumn(("Effect##" + headerUniqueId).c_str());
 			ImGui::TableSetupColumn(("State##" + headerUniqueId).c_str());
+			ImGui::TableSetupColumn(("Timing##" + headerUniqueId).c_str());
 			ImGui::TableSetupColumn(("Actions##" + headerUniqueId).c_str());
 			ImGui::TableSetupColumn(("Cell##" + headerUniqueId).c_str());
 			ImGui::TableHeadersRow();
@@ -524,6 +588,8 @@ void Menu::SpawnInteriorSettings(ImGuiID dockspace_id)
 				ImGui::TableNextColumn();
 				if (ImGui::Checkbox(effectStateId.c_str(), &currentEffectState)) { valueChanged = true; }
 				ImGui::TableNextColumn();
+				if (TimingInput("Timing##" + headerUniqueId + std::to_string(i), info.timing)) { valueChanged = true; }
+				ImGui::TableNextColumn();
 				if (ImGui::Button(removeId.c_str()))
 				{
 					updatedInfoList[cellName].erase(
@@ -542,6 +608,7 @@ void Menu::SpawnInteriorSettings(ImGuiID dockspace_id)
 						updatedInfoList.erase(cellName);
 					}
 
+					listChanged = true;
 					globalIndex--;
 					continue;
 				}
@@ -560,12 +627,16 @@ void Menu::SpawnInteriorSettings(ImGuiID dockspace_id)
 					info.effectName = currentEffectName;
 					info.state = currentEffectState;
 					updatedInfoList[cellName].at(i) = info;
+					listChanged = true;
 				}
 
 				if (m_editingEffectIndex == globalIndex)
 				{
 					auto& targetUniforms = updatedInfoList[cellName].at(i).uniforms;
-					HandleEffectEditing(targetUniforms, m_currentEditingEffect, m_editingEffectIndex);
+					if (HandleEffectEditing(targetUniforms, m_currentEditingEffect, m_editingEffectIndex))
+					{
+						listChanged = true;
+					}
 				}
 			}
 			ImGui::EndTable();
@@ -573,8 +644,11 @@ void Menu::SpawnInteriorSettings(ImGuiID dockspace_id)
 
 	}
 
-	// Update the manager with the new list
-	Manager::GetSingleton()->setInteriorToggleInfo(updatedInfoList);
+	// only recompile and wake the pass when something actually changed
+	if (listChanged)
+	{
+		Manager::GetSingleton()->setInteriorToggleInfo(updatedInfoList);
+	}
 
 	ImGui::SeparatorText("Add New");
 	// Add new effect
@@ -598,6 +672,7 @@ void Menu::SpawnWeatherSettings(ImGuiID dockspace_id)
 	std::map<std::string, std::vector<WeatherToggleInformation>> infoList = Manager::GetSingleton()->getWeatherToggleInfo();
 	std::map<std::string, std::vector<WeatherToggleInformation>> updatedInfoList = infoList; // Start with existing info
 	static char inputBuffer[256] = "";
+	bool listChanged = false;
 	ImGui::InputTextWithHint("##Search", "Search Worldspaces...", inputBuffer, sizeof(inputBuffer));
 
 	int headerId = -1;
@@ -613,9 +688,10 @@ void Menu::SpawnWeatherSettings(ImGuiID dockspace_id)
 
 		if (ImGui::CollapsingHeader((worldSpaceName + "##" + headerUniqueId + "##Header").c_str(), ImGuiTreeNodeFlags_AllowOverlap | ImGuiTreeNodeFlags_AllowItemOverlap))
 		{
-			ImGui::BeginTable(("EffectsTable##" + headerUniqueId).c_str(), 5, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg);
+			ImGui::BeginTable(("EffectsTable##" + headerUniqueId).c_str(), 6, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg);
 			ImGui::TableSetupColumn(("Effect##" + headerUniqueId).c_str());
 			ImGui::TableSetupColumn(("State##" + headerUniqueId).c_str());
+			ImGui::TableSetupColumn(("Timing##" + headerUniqueId).c_str());
 			ImGui::TableSetupColumn(("Weather##" + headerUniqueId).c_str());
 			ImGui::TableSetupColumn(("Actions##" + headerUniqueId).c_str());
 			ImGui::TableSetupColumn(("Worldspace##" + headerUniqueId).c_str());
@@ -642,6 +718,8 @@ void Menu::SpawnWeatherSettings(ImGuiID dockspace_id)
 				ImGui::TableNextColumn();
 				if (ImGui::Checkbox(effectStateId.c_str(), &currentEffectState)) { valueChanged = true; }
 				ImGui::TableNextColumn();
+				if (TimingInput("Timing##" + headerUniqueId + std::to_string(i), info.timing)) { valueChanged = true; }
+				ImGui::TableNextColumn();
 				if (CreateCombo(weatherId.c_str(), currentWeather, m_weathers, ImGuiComboFlags_None)) { valueChanged = true; }
 				ImGui::TableNextColumn();
 				if (ImGui::Button(removeId.c_str()))
@@ -662,6 +740,7 @@ void Menu::SpawnWeatherSettings(ImGuiID dockspace_id)
 						updatedInfoList.erase(worldSpaceName);
 					}
 
+					listChanged = true;
 					globalIndex--;
 					continue;
 				}
@@ -681,12 +760,16 @@ void Menu::SpawnWeatherSettings(ImGuiID dockspace_id)
 					info.weather = currentWeather;
 					info.state = currentEffectState;
 					updatedInfoList[worldSpaceName].at(i) = info;
+					listChanged = true;
 				}
 
 				if (m_editingEffectIndex == globalIndex)
 				{
 					auto& targetUniforms = updatedInfoList[worldSpaceName].at(i).uniforms;
-					HandleEffectEditing(targetUniforms, m_currentEditingEffect, m_editingEffectIndex);
+					if (HandleEffectEditing(targetUniforms, m_currentEditingEffect, m_editingEffectIndex))
+					{
+						listChanged = true;
+					}
 				}
 			}
 			ImGui::EndTable();
@@ -694,8 +777,11 @@ void Menu::SpawnWeatherSettings(ImGuiID dockspace_id)
 
 	}
 
-	// Update the manager with the new list
-	Manager::GetSingleton()->setWeatherToggleInfo(updatedInfoList);
+	// only invalidate the weather fingerprint and wake the pass when something actually changed
+	if (listChanged)
+	{
+		Manager::GetSingleton()->setWeatherToggleInfo(updatedInfoList);
+	}
 
 	ImGui::SeparatorText("Add New");
 	// Add new effect
@@ -708,13 +794,452 @@ void Menu::SpawnWeatherSettings(ImGuiID dockspace_id)
 	ImGui::End();
 }
 
-void Menu::AddNewTime(std::map<std::string, std::vector<TimeToggleInformation>>& updatedInfoList)
+void Menu::SpawnRuleSettings(ImGuiID dockspace_id)
 {
-	static float currentStartTime;
-	static float currentStopTime;
+	ImGui::SetNextWindowDockID(dockspace_id, ImGuiCond_Always);
+	ImGui::Begin("Rule Settings", &m_showRuleSettings, ImGuiWindowFlags_NoCollapse);
+	ImGui::Text("Configure rules that combine several conditions here. All conditions of a rule have to be met.");
+	ImGui::SeparatorText("Rules");
+
+	std::vector<RuleToggleInformation> infoList = Manager::GetSingleton()->getRuleToggleInfo();
+	std::vector<RuleToggleInformation> updatedInfoList = infoList;
+	bool listChanged = false;
+
+	if (!infoList.empty() && ImGui::BeginTable("RulesTable", 8, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg))
+	{
+		ImGui::TableSetupColumn("Effect");
+		ImGui::TableSetupColumn("State");
+		ImGui::TableSetupColumn("Timing");
+		ImGui::TableSetupColumn("Hours");
+		ImGui::TableSetupColumn("Location");
+		ImGui::TableSetupColumn("Menu");
+		ImGui::TableSetupColumn("Weather");
+		ImGui::TableSetupColumn("Actions");
+		ImGui::TableHeadersRow();
+
+		for (int i = 0; i < infoList.size(); i++)
+		{
+			RuleToggleInformation info = infoList[i];
+			bool valueChanged = false;
+			const std::string rowId = "##Rule" + std::to_string(i);
+
+			ImGui::TableNextRow();
+			ImGui::TableNextColumn();
+			if (CreateCombo(("Effect" + rowId).c_str(), info.effectName, m_effects, ImGuiComboFlags_None)) { valueChanged = true; }
+			ImGui::TableNextColumn();
+			if (ImGui::Checkbox(("State" + rowId).c_str(), &info.state)) { valueChanged = true; }
+			ImGui::TableNextColumn();
+			if (TimingInput("Timing" + rowId, info.timing)) { valueChanged = true; }
+
+			ImGui::TableNextColumn();
+			ImGui::PushItemWidth(80);
+			if (ImGui::SliderInt(("##StartHour" + rowId).c_str(), &info.startHour, 0, 23, "%02d:00")) { valueChanged = true; }
+			ImGui::SameLine();
+			ImGui::Text("-");
+			ImGui::SameLine();
+			if (ImGui::SliderInt(("##StopHour" + rowId).c_str(), &info.stopHour, 0, 23, "%02d:00")) { valueChanged = true; }
+			ImGui::PopItemWidth();
+
+			ImGui::TableNextColumn();
+			if (CreateCombo(("##Location" + rowId).c_str(), info.location, m_ruleLocations, ImGuiComboFlags_None)) { valueChanged = true; }
+			ImGui::TableNextColumn();
+			if (CreateCombo(("##Menu" + rowId).c_str(), info.menu, m_ruleMenus, ImGuiComboFlags_None)) { valueChanged = true; }
+
+			ImGui::TableNextColumn();
+			for (const auto& weather : Rules::s_weatherOptions)
+			{
+				const auto it = std::find(info.weathers.begin(), info.weathers.end(), weather);
+				bool selected = it != info.weathers.end();
+				if (ImGui::Checkbox((weather + rowId).c_str(), &selected))
+				{
+					if (selected)
+						info.weathers.emplace_back(weather);
+					else
+						info.weathers.erase(it);
+					valueChanged = true;
+				}
+			}
+
+			ImGui::TableNextColumn();
+			if (ImGui::Button(("Remove" + rowId).c_str()))
+			{
+				updatedInfoList.erase(updatedInfoList.begin() + (i - (infoList.size() - updatedInfoList.size())));
+				listChanged = true;
+				continue;
+			}
+			if (ImGui::Button(("Edit" + rowId).c_str()))
+			{
+				m_currentEditingEffect = info.effectName;
+				m_editingEffectIndex = i;
+				ImGui::OpenPopup("Edit Effect Values");
+			}
 
-	static char startHourStr[3] = "00", startMinuteStr[3] = "00";
-	static char stopHourStr[3] = "00", stopMinuteStr[3] = "00";
+			const size_t updatedIndex = i - (infoList.size() - updatedInfoList.size());
+			if (valueChanged)
+			{
+				updatedInfoList.at(updatedIndex) = info;
+				listChanged = true;
+			}
+
+			if (m_editingEffectIndex == i)
+			{
+				if (HandleEffectEditing(updatedInfoList.at(updatedIndex).uniforms, m_currentEditingEffect, m_editingEffectIndex))
+				{
+					listChanged = true;
+				}
+			}
+		}
+
+		ImGui::EndTable();
+	}
+
+	// only recompile the rules when something actually changed
+	if (listChanged)
+	{
+		Manager::GetSingleton()->setRuleToggleInfo(updatedInfoList);
+	}
+
+	ImGui::SeparatorText("Add New");
+	if (ImGui::Button("Add New Rule"))
+	{
+		ImGui::OpenPopup("Create Rule Entries");
+	}
+	AddNewRule(updatedInfoList);
+
+	ImGui::End();
+}
+
+void Menu::AddNewRule(std::vector<RuleToggleInformation>& updatedInfoList)
+{
+	static RuleToggleInformation newRule;
+
+	if (ImGui::BeginPopupModal("Create Rule Entries", NULL, ImGuiWindowFlags_None))
+	{
+		if (ImGui::IsWindowAppearing())
+		{
+			newRule = RuleToggleInformation{};
+			m_currentEffects.clear();
+			m_toggleState = false;
+			m_entireReShadeToggleOn = false;
+			m_inputBuffer01[0] = '\0';
+		}
+
+		ImVec2 availableSpace = ImGui::GetContentRegionAvail();
+		float childHeight = availableSpace.y * 0.35f;
+
+		ImGui::SeparatorText("Conditions");
+		ImGui::PushItemWidth(120);
+		ImGui::SliderInt("Start Hour", &newRule.startHour, 0, 23, "%02d:00");
+		ImGui::SameLine();
+		ImGui::SliderInt("Stop Hour", &newRule.stopHour, 0, 23, "%02d:00");
+		ImGui::PopItemWidth();
+		ImGui::TextDisabled("Same start and stop hour means the whole day. Ranges can wrap past midnight.");
+
+		CreateCombo("Location", newRule.location, m_ruleLocations, ImGuiComboFlags_None);
+		CreateCombo("Menu", newRule.menu, m_ruleMenus, ImGuiComboFlags_None);
+
+		ImGui::Text("Weather (any of, none selected means every weather):");
+		for (const auto& weather : Rules::s_weatherOptions)
+		{
+			const auto it = std::find(newRule.weathers.begin(), newRule.weathers.end(), weather);
+			bool selected = it != newRule.weathers.end();
+			ImGui::SameLine();
+			if (ImGui::Checkbox((weather + "##NewRule").c_str(), &selected))
+			{
+				if (selected)
+					newRule.weathers.emplace_back(weather);
+				else
+					newRule.weathers.erase(it);
+			}
+		}
+
+		EffectOptions();
+
+		ImGui::SeparatorText("Select Effects");
+		ImGui::BeginChild("EffectsRegion", ImVec2(availableSpace.x, childHeight), true, ImGuiWindowFlags_HorizontalScrollbar);
+		CreateTreeNode("Effects", m_currentEffects, m_effects, m_inputBuffer01, sizeof(m_inputBuffer01), m_entireReShadeToggleOn);
+		ImGui::EndChild();
+
+		ImGui::Separator();
+		if (ImGui::Button("Finish"))
+		{
+			for (const auto& effect : m_currentEffects)
+			{
+				RuleToggleInformation rule = newRule;
+				rule.effectName = effect;
+				rule.state = m_toggleState;
+				updatedInfoList.emplace_back(std::move(rule));
+			}
+
+			Manager::GetSingleton()->setRuleToggleInfo(updatedInfoList);
+
+			ImGui::CloseCurrentPopup();
+		}
+
+		ImGui::SameLine();
+		if (ImGui::Button("Cancel"))
+		{
+			ImGui::CloseCurrentPopup();
+		}
+
+		ImGui::EndPopup();
+	}
+}
+
+void Menu::SpawnPerformancePage(ImGuiID dockspace_id)
+{
+	ImGui::SetNextWindowDockID(dockspace_id, ImGuiCond_Always);
+	ImGui::Begin("Performance", nullptr, ImGuiWindowFlags_NoCollapse);
+
+	ImGui::SeparatorText("Zones");
+#ifndef ENABLE_PROFILER
+	ImGui::TextColored(ImVec4(1.0f, 0.5f, 0.0f, 1.0f), "Timing zones are not compiled into this build. Configure with -DENABLE_PROFILER=ON to enable them.");
+#else
+	const auto profiler = Profiler::GetSingleton();
+
+	ImGui::Text("Rolling statistics over the last %u samples per zone.", Profiler::s_windowSize);
+	ImGui::SameLine();
+	if (ImGui::Button("Reset"))
+	{
+		profiler->reset();
+	}
+
+	if (ImGui::BeginTable("PerformanceTable", 5, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg))
+	{
+		ImGui::TableSetupColumn("Zone");
+		ImGui::TableSetupColumn("Min (ms)");
+		ImGui::TableSetupColumn("Avg (ms)");
+		ImGui::TableSetupColumn("p99 (ms)");
+		ImGui::TableSetupColumn("Samples");
+		ImGui::TableHeadersRow();
+
+		for (std::uint8_t i = 0; i < static_cast<std::uint8_t>(Profiler::Zone::kTotal); i++)
+		{
+			const auto zone = static_cast<Profiler::Zone>(i);
+			const auto stats = profiler->getStats(zone);
+
+			ImGui::TableNextRow();
+			ImGui::TableNextColumn();
+			ImGui::Text("%s", Profiler::getZoneName(zone));
+			ImGui::TableNextColumn();
+			ImGui::Text("%.4f", stats.minMs);
+			ImGui::TableNextColumn();
+			ImGui::Text("%.4f", stats.avgMs);
+			ImGui::TableNextColumn();
+			ImGui::Text("%.4f", stats.p99Ms);
+			ImGui::TableNextColumn();
+			ImGui::Text("%u", stats.sampleCount);
+		}
+
+		ImGui::EndTable();
+	}
+
+	ImGui::Text("Dropped samples: %llu", profiler->getDroppedSamples());
+#endif
+
+	ImGui::SeparatorText("Rule Evaluation");
+	ImGui::Text("Evaluator in use: %s", Rules::getEvaluatorName(Rules::getBestEvaluator()));
+	pollTask(m_ruleBenchmarkTask, m_ruleBenchmark);
+	if (m_ruleBenchmarkTask.valid())
+	{
+		ImGui::TextDisabled("Running rule benchmark...");
+	}
+	else if (ImGui::Button("Run Rule Benchmark"))
+	{
+		m_ruleBenchmarkTask = std::async(std::launch::async, Rules::runBenchmark);
+	}
+
+	if (!m_ruleBenchmark.empty() && ImGui::BeginTable("RuleBenchmarkTable", 5, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg))
+	{
+		ImGui::TableSetupColumn("Rules");
+		ImGui::TableSetupColumn("Scalar (us)");
+		ImGui::TableSetupColumn("SSE2 (us)");
+		ImGui::TableSetupColumn("AVX2 (us)");
+		ImGui::TableSetupColumn("Results match");
+		ImGui::TableHeadersRow();
+
+		for (const auto& result : m_ruleBenchmark)
+		{
+			ImGui::TableNextRow();
+			ImGui::TableNextColumn();
+			ImGui::Text("%zu", result.ruleCount);
+			ImGui::TableNextColumn();
+			ImGui::Text("%.2f", result.scalarUs);
+			ImGui::TableNextColumn();
+			ImGui::Text("%.2f", result.sseUs);
+			ImGui::TableNextColumn();
+			if (result.avxUs > 0.0)
+				ImGui::Text("%.2f", result.avxUs);
+			else
+				ImGui::TextDisabled("n/a");
+			ImGui::TableNextColumn();
+			ImGui::Text("%s", result.resultsMatch ? "yes" : "no");
+		}
+
+		ImGui::EndTable();
+	}
+
+	ImGui::SeparatorText("Preset Compile");
+	const auto pool = CompilePool::GetSingleton();
+	ImGui::Text("Compile threads: %u, tasks stolen: %llu", pool->getThreadCount(), pool->getStolenTasks());
+	pollTask(m_compileBenchmarkTask, m_compileBenchmark);
+	if (m_compileBenchmarkTask.valid())
+	{
+		ImGui::TextDisabled("Running compile benchmark...");
+	}
+	else if (ImGui::Button("Run Compile Benchmark"))
+	{
+		m_compileBenchmarkTask = std::async(std::launch::async, []() { return Manager::runCompileBenchmark(); });
+	}
+
+	if (!m_compileBenchmark.empty() && ImGui::BeginTable("CompileBenchmarkTable", 4, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg))
+	{
+		ImGui::TableSetupColumn("Rules");
+		ImGui::TableSetupColumn("Threads");
+		ImGui::TableSetupColumn("Compile (ms)");
+		ImGui::TableSetupColumn("Speedup");
+		ImGui::TableHeadersRow();
+
+		for (const auto& result : m_compileBenchmark)
+		{
+			ImGui::TableNextRow();
+			ImGui::TableNextColumn();
+			ImGui::Text("%zu", result.ruleCount);
+			ImGui::TableNextColumn();
+			ImGui::Text("%u", result.threads);
+			ImGui::TableNextColumn();
+			ImGui::Text("%.2f", result.ms);
+			ImGui::TableNextColumn();
+			ImGui::Text("%.2fx", result.speedup);
+		}
+
+		ImGui::EndTable();
+	}
+
+	ImGui::SeparatorText("Scheduler");
+	const auto scheduler = TickScheduler::GetSingleton();
+	const auto now = TickScheduler::Clock::now();
+	for (std::uint8_t i = 0; i < static_cast<std::uint8_t>(TickScheduler::Pass::kTotal); i++)
+	{
+		const auto pass = static_cast<TickScheduler::Pass>(i);
+		const auto remaining = scheduler->getRemainingMs(pass, now);
+		if (remaining < 0)
+			ImGui::Text("%s pass: waiting for an event", TickScheduler::getPassName(pass));
+		else
+			ImGui::Text("%s pass: in %lld ms", TickScheduler::getPassName(pass), remaining);
+
+		// evaluations that found the state of the previous one and returned right away
+		const auto& fingerprint = Manager::GetSingleton()->getFingerprint(pass);
+		ImGui::SameLine();
+		ImGui::TextDisabled("(unchanged %.1f%% of %llu)", fingerprint.getHitRate() * 100.f, fingerprint.getHits() + fingerprint.getMisses());
+	}
+
+	ImGui::SeparatorText("Frame Governor");
+	const auto governor = FrameGovernor::GetSingleton();
+	const auto governorConfig = governor->getConfig();
+	if (!governorConfig.enabled)
+	{
+		ImGui::TextDisabled("Disabled, see [Governor] in the INI");
+	}
+	else
+	{
+		ImGui::Text("Frame time p%.0f: %.2f ms (target %.2f ms)", governorConfig.percentile * 100.f, governor->getPercentileMs(), governorConfig.targetMs);
+
+		const auto candidates = governor->getCandidates();
+		if (!candidates.empty() && ImGui::BeginTable("GovernorTable", 4, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg))
+		{
+			ImGui::TableSetupColumn("Effect");
+			ImGui::TableSetupColumn("Priority");
+			ImGui::TableSetupColumn("Measured cost (ms)");
+			ImGui::TableSetupColumn("Shed");
+			ImGui::TableHeadersRow();
+
+			for (const auto& candidate : candidates)
+			{
+				ImGui::TableNextRow();
+				ImGui::TableNextColumn();
+				ImGui::Text("%s", EffectTable::GetSingleton()->getName(candidate.effect));
+				ImGui::TableNextColumn();
+				ImGui::Text("%d", candidate.priority);
+				ImGui::TableNextColumn();
+				ImGui::Text("%.2f", candidate.measuredCostMs);
+				ImGui::TableNextColumn();
+				ImGui::Text("%s", candidate.shed ? "yes" : "no");
+			}
+
+			ImGui::EndTable();
+		}
+	}
+
+	ImGui::SeparatorText("Runtimes");
+	ImGui::Text("Active effect runtimes: %zu", RuntimeRegistry::GetSingleton()->size());
+	ImGui::Text("Coalesced on overflow: %llu", CommandQueue::GetSingleton()->getCoalescedCommands());
+	ImGui::Text("Coalesced toggles: %llu", Manager::GetSingleton()->getCoalescedToggles());
+	ImGui::Text("Debounced flips: %zu pending, %llu cancelled", ToggleDebouncer::GetSingleton()->getPendingCount(), ToggleDebouncer::GetSingleton()->getCancelledCount());
+	ImGui::Text("Pre-warmed effects: %zu sent, %zu pending", EffectPrewarmer::GetSingleton()->getSentCount(), EffectPrewarmer::GetSingleton()->getPendingCount());
+
+	const auto switchStats = Manager::GetSingleton()->getPresetSwitchStats();
+	ImGui::Text("Last preset switch: %u writes, %u already applied, %u replaced", switchStats.writes, switchStats.skipped, switchStats.dropped);
+
+	ImGui::SeparatorText("Uniforms");
+	ImGui::Text("Keyframed uniforms: %zu", UniformAnimator::GetSingleton()->size());
+	ImGui::Text("Bound uniforms: %zu", UniformBindings::GetSingleton()->size());
+	ImGui::Text("Transitions in flight: %zu", UniformTransitions::GetSingleton()->size());
+	ImGui::Text("Held by rules: %zu", UniformBaseline::GetSingleton()->getHeldCount());
+
+	ImGui::SeparatorText("Toggle Journal");
+	const auto manager = Manager::GetSingleton();
+	const auto journal = Journal::GetSingleton();
+
+	bool journalEnabled = manager->isJournalEnabled();
+	if (ImGui::Checkbox("Record technique and uniform writes", &journalEnabled))
+	{
+		manager->setJournalEnabled(journalEnabled);
+		manager->serializeINI();
+
+		if (journalEnabled)
+		{
+			journal->start();
+		}
+		else
+		{
+			journal->stop();
+		}
+	}
+
+	ImGui::Text("Written records: %llu, dropped records: %llu", journal->getWrittenRecords(), journal->getDroppedRecords());
+	ImGui::Text("Journal: %s", journal->getLogPath().string().c_str());
+
+	if (ImGui::Button("Export Journal as CSV"))
+	{
+		auto csvPath = journal->getLogPath();
+		csvPath.replace_extension(".csv");
+
+		if (Journal::decodeToCSV(journal->getLogPath(), csvPath))
+		{
+			m_lastMessage = "Exported toggle journal to '" + csvPath.string() + "'.";
+			m_lastMessageColor = ImVec4(0.0f, 1.0f, 0.0f, 1.0f);
+		}
+		else
+		{
+			m_lastMessage = "Failed to export toggle journal.";
+			m_lastMessageColor = ImVec4(1.0f, 0.0f, 0.0f, 1.0f);
+		}
+	}
+
+	if (!m_lastMessage.empty())
+	{
+		ImGui::TextColored(m_lastMessageColor, "%s", m_lastMessage.c_str());
+	}
+
+	ImGui::End();
+}
+
+void Menu::AddNewTime(std::map<std::string, std::vector<TimeToggleInformation>>& updatedInfoList)
+{
+	static std::uint16_t startMinute = 0;
+	static std::uint16_t stopMinute = 0;
+	static TimeToggleInformation newDates;
 
 	if (ImGui::BeginPopupModal("Create Time Entries", NULL, ImGuiWindowFlags_None))
 	{
@@ -726,10 +1251,9 @@ void Menu::AddNewTime(std::map<std::string, std::vector<TimeToggleInformation>>&
 			m_entireReShadeToggleOn = false;
 			m_inputBuffer01[0] = '\0';
 			m_inputBuffer02[0] = '\0';
-			strcpy(startHourStr, "00");
-			strcpy(startMinuteStr, "00");
-			strcpy(stopHourStr, "00");
-			strcpy(stopMinuteStr, "00");
+			startMinute = 0;
+			stopMinute = 0;
+			newDates = TimeToggleInformation{};
 		}
 
 		ImVec2 availableSpace = ImGui::GetContentRegionAvail();
@@ -742,37 +1266,22 @@ void Menu::AddNewTime(std::map<std::string, std::vector<TimeToggleInformation>>&
 
 		ImGui::SeparatorText("Select Time Period");
 
-		// Start time
 		ImGui::Text("Start Time: ");
 		ImGui::SameLine();
-		ImGui::TableNextColumn();
-		ImGui::PushItemWidth(35);
-		ImGui::InputText("##StartHours", startHourStr, sizeof(startHourStr), ImGuiInputTextFlags_CharsDecimal);
-		ClampInputValue(startHourStr, 23);
-		if (strcmp(startHourStr, "00") == 0 && strlen(startHourStr) == 0) strcpy(startHourStr, "0");
-		ImGui::SameLine();
-		ImGui::Text(":");
-		ImGui::SameLine();
-		ImGui::InputText("##StartMinutes", startMinuteStr, sizeof(startMinuteStr), ImGuiInputTextFlags_CharsDecimal);
-		ClampInputValue(startMinuteStr, 59);
-		if (strcmp(startMinuteStr, "00") == 0 && strlen(startMinuteStr) == 0) strcpy(startMinuteStr, "0");
-		ImGui::PopItemWidth();
+		TimeInput("Start", startMinute);
 
-		// Stop Time
 		ImGui::Text("Stop Time: ");
 		ImGui::SameLine();
-		ImGui::TableNextColumn();
-		ImGui::PushItemWidth(35);
-		ImGui::InputText("##StopHours", stopHourStr, sizeof(stopHourStr), ImGuiInputTextFlags_CharsDecimal);
-		ClampInputValue(stopHourStr, 23);
-		if (strcmp(stopHourStr, "00") == 0 && strlen(stopHourStr) == 0) strcpy(stopHourStr, "0");
-		ImGui::SameLine();
-		ImGui::Text(":");
-		ImGui::SameLine();
-		ImGui::InputText("##StopMinutes", stopMinuteStr, sizeof(stopMinuteStr), ImGuiInputTextFlags_CharsDecimal);
-		ClampInputValue(stopMinuteStr, 59);
-		if (strcmp(stopMinuteStr, "00") == 0 && strlen(stopMinuteStr) == 0) strcpy(stopMinuteStr, "0");
-		ImGui::PopItemWidth();
+		TimeInput("Stop", stopMinute);
+
+		if (startMinute > stopMinute)
+		{
+			ImGui::TextDisabled("Wraps past midnight");
+		}
+
+		ImGui::SeparatorText("Select Dates");
+		ImGui::TextDisabled("Nothing selected means every day.");
+		DateConditions("NewTime", newDates);
 
 		EffectOptions();
 
@@ -784,21 +1293,15 @@ void Menu::AddNewTime(std::map<std::string, std::vector<TimeToggleInformation>>&
 		ImGui::Separator();
 		if (ImGui::Button("Finish"))
 		{
-			// Convert the input text to integers
-			const int startHours = strlen(startHourStr) > 0 ? std::stoi(startHourStr) : 0;
-			const int startMinutes = strlen(startMinuteStr) > 0 ? std::stoi(startMinuteStr) : 0;
-			const int stopHours = strlen(stopHourStr) > 0 ? std::stoi(stopHourStr) : 0;
-			const int stopMinutes = strlen(stopMinuteStr) > 0 ? std::stoi(stopMinuteStr) : 0;
-
-			// Convert hours and minutes into float (HH.MM) format
-			currentStartTime = startHours + (startMinutes / 100.0f);
-			currentStopTime = stopHours + (stopMinutes / 100.0f);
-
 			for (const auto& ws : m_currentToggleReason)
 			{
 				for (const auto& effect : m_currentEffects)
 				{
-					updatedInfoList[ws].emplace_back(TimeToggleInformation{ effect, currentStartTime, currentStopTime, m_toggleState });
+					TimeToggleInformation info{ effect, { { startMinute, stopMinute } }, m_toggleState };
+					info.days = newDates.days;
+					info.months = newDates.months;
+					info.seasons = newDates.seasons;
+					updatedInfoList[ws].emplace_back(std::move(info));
 				}
 			}
 
@@ -827,8 +1330,101 @@ void Menu::ClampInputValue(char* inputStr, int maxVal)
 	}
 }
 
-void Menu::EditValues(const std::string& effectName, std::vector<UniformInfo>& toReturn)
+bool Menu::TimeInput(const std::string& id, std::uint16_t& minuteOfDay)
 {
+	char hourStr[3];
+	char minuteStr[3];
+	snprintf(hourStr, sizeof(hourStr), "%02d", minuteOfDay / 60);
+	snprintf(minuteStr, sizeof(minuteStr), "%02d", minuteOfDay % 60);
+
+	bool valueChanged = false;
+
+	ImGui::PushItemWidth(35);
+	if (ImGui::InputText(("##Hours" + id).c_str(), hourStr, sizeof(hourStr), ImGuiInputTextFlags_CharsDecimal)) { valueChanged = true; }
+	ClampInputValue(hourStr, 23);
+	ImGui::SameLine();
+	ImGui::Text(":");
+	ImGui::SameLine();
+	if (ImGui::InputText(("##Minutes" + id).c_str(), minuteStr, sizeof(minuteStr), ImGuiInputTextFlags_CharsDecimal)) { valueChanged = true; }
+	ClampInputValue(minuteStr, 59);
+	ImGui::PopItemWidth();
+
+	const int hours = strlen(hourStr) > 0 ? std::stoi(hourStr) : 0;
+	const int minutes = strlen(minuteStr) > 0 ? std::stoi(minuteStr) : 0;
+	minuteOfDay = GameTime::toMinuteOfDay(hours, minutes);
+
+	return valueChanged;
+}
+
+bool Menu::TimingInput(const std::string& id, ToggleTiming& timing)
+{
+	int debounceMs = static_cast<int>(timing.debounceMs);
+	int minDurationMs = static_cast<int>(timing.minDurationMs);
+
+	bool valueChanged = false;
+
+	// a flip waits for the debounce window, and for the effect to have kept its state for the minimum duration
+	ImGui::PushItemWidth(70);
+	if (ImGui::DragInt(("##Debounce" + id).c_str(), &debounceMs, 10.0f, 0, 60000, "%d ms")) { valueChanged = true; }
+	if (ImGui::IsItemHovered()) { ImGui::SetTooltip("Debounce: the rule has to hold for this long before the effect flips"); }
+	ImGui::SameLine();
+	if (ImGui::DragInt(("##MinDuration" + id).c_str(), &minDurationMs, 10.0f, 0, 60000, "%d ms")) { valueChanged = true; }
+	if (ImGui::IsItemHovered()) { ImGui::SetTooltip("Minimum duration: the effect keeps a state for at least this long"); }
+	ImGui::PopItemWidth();
+
+	timing.debounceMs = static_cast<std::uint32_t>(std::clamp(debounceMs, 0, 60000));
+	timing.minDurationMs = static_cast<std::uint32_t>(std::clamp(minDurationMs, 0, 60000));
+
+	return valueChanged;
+}
+
+bool Menu::MultiSelectCombo(const std::string& label, std::vector<std::string>& selected, const std::vector<std::string>& options)
+{
+	std::string preview;
+	for (const auto& option : selected)
+	{
+		preview += preview.empty() ? option : ", " + option;
+	}
+
+	bool valueChanged = false;
+	if (ImGui::BeginCombo(label.c_str(), preview.empty() ? "Any" : preview.c_str()))
+	{
+		for (const auto& option : options)
+		{
+			const auto it = std::find(selected.begin(), selected.end(), option);
+			bool isSelected = it != selected.end();
+			if (ImGui::Checkbox(option.c_str(), &isSelected))
+			{
+				if (isSelected)
+					selected.emplace_back(option);
+				else
+					selected.erase(it);
+				valueChanged = true;
+			}
+		}
+		ImGui::EndCombo();
+	}
+
+	return valueChanged;
+}
+
+bool Menu::DateConditions(const std::string& id, TimeToggleInformation& info)
+{
+	bool valueChanged = false;
+
+	ImGui::PushItemWidth(150);
+	if (MultiSelectCombo("Days##" + id, info.days, GameTime::s_dayOptions)) { valueChanged = true; }
+	if (MultiSelectCombo("Months##" + id, info.months, GameTime::s_monthOptions)) { valueChanged = true; }
+	if (MultiSelectCombo("Seasons##" + id, info.seasons, GameTime::s_seasonOptions)) { valueChanged = true; }
+	ImGui::PopItemWidth();
+
+	return valueChanged;
+}
+
+bool Menu::EditValues(const std::string& effectName, std::vector<UniformInfo>& toReturn)
+{
+	bool changed = false;
+
 	ImGui::GetIO().ConfigDragClickToInputText = true;
 	if (ImGui::BeginPopupModal("Edit Effect Values", NULL, ImGuiWindowFlags_AlwaysAutoResize))
 	{
@@ -847,10 +1443,10 @@ void Menu::EditValues(const std::string& effectName, std::vector<UniformInfo>& t
 		{
 			if (var.uniformVariable.handle == 0) // if 0 it's loaded from a preset
 			{
-				var.uniformVariable = s_pRuntime->find_uniform_variable(effectName.c_str(), var.uniformName.c_str());
-				format baseType = format::unknown;
-
-				s_pRuntime->get_uniform_variable_type(var.uniformVariable, &baseType);
+				RuntimeRegistry::GetSingleton()->withPrimary([&](reshade::api::effect_runtime* runtime) {
+					var.uniformVariable = runtime->find_uniform_variable(effectName.c_str(), var.uniformName.c_str());
+					});
+				const format baseType = manager->getUniformType(var.uniformVariable);
 
 				switch (baseType)
 				{
@@ -877,8 +1473,7 @@ void Menu::EditValues(const std::string& effectName, std::vector<UniformInfo>& t
 			if (info.prefetched)
 				return;
 
-			format baseType = format::unknown;
-			s_pRuntime->get_uniform_variable_type(info.uniformVariable, &baseType);
+			const format baseType = manager->getUniformType(info.uniformVariable);
 
 			switch (baseType)
 			{
@@ -927,14 +1522,14 @@ void Menu::EditValues(const std::string& effectName, std::vector<UniformInfo>& t
 			{
 				FetchUniformValue(uniformInfo);
 				toReturn.emplace_back(uniformInfo);
+				changed = true;
 			}
 		}
 
 		// Iterate through `toReturn` to handle UI interaction
 		for (auto& uniformInfo : toReturn)
 		{
-			format baseType = format::unknown;
-			s_pRuntime->get_uniform_variable_type(uniformInfo.uniformVariable, &baseType);
+			const format baseType = manager->getUniformType(uniformInfo.uniformVariable);
 
 			if (uniformInfo.prefetched)
 			{
@@ -950,24 +1545,28 @@ void Menu::EditValues(const std::string& effectName, std::vector<UniformInfo>& t
 						if (ImGui::SliderFloat(uniformInfo.uniformName.c_str(), &uniformInfo.tempFloatValues[0], -64.0f, 64.0f))
 						{
 							uniformInfo.setFloatValues(uniformInfo.tempFloatValues, 1);
+							changed = true;
 						}
 						break;
 					case 2:
 						if (ImGui::SliderFloat2(uniformInfo.uniformName.c_str(), uniformInfo.tempFloatValues, -64.0f, 64.0f))
 						{
 							uniformInfo.setFloatValues(uniformInfo.tempFloatValues, 2);
+							changed = true;
 						}
 						break;
 					case 3:
 						if (ImGui::ColorEdit3(uniformInfo.uniformName.c_str(), uniformInfo.tempFloatValues))
 						{
 							uniformInfo.setFloatValues(uniformInfo.tempFloatValues, 3);
+							changed = true;
 						}
 						break;
 					case 4:
 						if (ImGui::ColorEdit4(uniformInfo.uniformName.c_str(), uniformInfo.tempFloatValues))
 						{
 							uniformInfo.setFloatValues(uniformInfo.tempFloatValues, 4);
+							changed = true;
 						}
 						break;
 					}
@@ -983,23 +1582,27 @@ void Menu::EditValues(const std::string& effectName, std::vector<UniformInfo>& t
 						if (ImGui::SliderInt(uniformInfo.uniformName.c_str(), &uniformInfo.tempIntValues[0], -64, 64))
 						{
 							uniformInfo.setIntValues(uniformInfo.tempIntValues, 1);
+							changed = true;
 						}
 						break;
 					case 2:
 						if (ImGui::SliderInt2(uniformInfo.uniformName.c_str(), uniformInfo.tempIntValues, -64, 64))
 						{
 							uniformInfo.setIntValues(uniformInfo.tempIntValues, 2);
+							changed = true;
 							break;
 					case 3:
 						if (ImGui::SliderInt3(uniformInfo.uniformName.c_str(), uniformInfo.tempIntValues, -64, 64))
 						{
 							uniformInfo.setIntValues(uniformInfo.tempIntValues, 3);
+							changed = true;
 						}
 						break;
 					case 4:
 						if (ImGui::SliderInt4(uniformInfo.uniformName.c_str(), uniformInfo.tempIntValues, -64, 64))
 						{
 							uniformInfo.setIntValues(uniformInfo.tempIntValues, 4);
+							changed = true;
 						}
 						break;
 						}
@@ -1017,24 +1620,28 @@ void Menu::EditValues(const std::string& effectName, std::vector<UniformInfo>& t
 						if (ImGui::SliderScalar(uniformInfo.uniformName.c_str(), ImGuiDataType_U32, &uniformInfo.tempUIntValues[0], 0, reinterpret_cast<void*>(64)))
 						{
 							uniformInfo.setUIntValues(uniformInfo.tempUIntValues, 1);
+							changed = true;
 						}
 						break;
 					case 2:
 						if (ImGui::SliderScalarN(uniformInfo.uniformName.c_str(), ImGuiDataType_U32, uniformInfo.tempUIntValues, 2, 0, reinterpret_cast<void*>(64)))
 						{
 							uniformInfo.setUIntValues(uniformInfo.tempUIntValues, 2);
+							changed = true;
 						}
 						break;
 					case 3:
 						if (ImGui::SliderScalarN(uniformInfo.uniformName.c_str(), ImGuiDataType_U32, uniformInfo.tempUIntValues, 3, 0, reinterpret_cast<void*>(64)))
 						{
 							uniformInfo.setUIntValues(uniformInfo.tempUIntValues, 3);
+							changed = true;
 						}
 						break;
 					case 4:
 						if (ImGui::SliderScalarN(uniformInfo.uniformName.c_str(), ImGuiDataType_U32, uniformInfo.tempUIntValues, 4, 0, reinterpret_cast<void*>(64)))
 						{
 							uniformInfo.setUIntValues(uniformInfo.tempUIntValues, 4);
+							changed = true;
 						}
 						break;
 					}
@@ -1045,6 +1652,7 @@ void Menu::EditValues(const std::string& effectName, std::vector<UniformInfo>& t
 					if (ImGui::Checkbox(uniformInfo.uniformName.c_str(), &uniformInfo.tempBoolValue))
 					{
 						uniformInfo.setBoolValues(static_cast<uint8_t>(uniformInfo.tempBoolValue));
+						changed = true;
 					}
 				}
 				break;
@@ -1066,6 +1674,8 @@ void Menu::EditValues(const std::string& effectName, std::vector<UniformInfo>& t
 
 		ImGui::EndPopup();
 	}
+
+	return changed;
 }
 
 
@@ -1256,7 +1866,7 @@ void Menu::SaveFile()
 }
 
 
-void Menu::HandleEffectEditing(std::vector<UniformInfo>& targetUniforms, std::string& currentEditingEffect, int& editingEffectIndex)
+bool Menu::HandleEffectEditing(std::vector<UniformInfo>& targetUniforms, std::string& currentEditingEffect, int& editingEffectIndex)
 {
 	static std::vector<UniformInfo> uniformInfos;
 
@@ -1264,7 +1874,7 @@ void Menu::HandleEffectEditing(std::vector<UniformInfo>& targetUniforms, std::st
 
 	uniformInfos = std::move(targetUniforms);
 
-	EditValues(currentEditingEffect, uniformInfos);
+	const bool changed = EditValues(currentEditingEffect, uniformInfos);
 
 	if (!uniformInfos.empty())
 	{
@@ -1278,6 +1888,8 @@ void Menu::HandleEffectEditing(std::vector<UniformInfo>& targetUniforms, std::st
 		currentEditingEffect.clear();
 		uniformInfos.clear();
 	}
+
+	return changed;
 }
 
 void Menu::EffectOptions()
@@ -1,5 +1,6 @@
 #include "Papyrus.h"
 #include "Manager.h"
+#include "Menu.h"
 
 namespace Papyrus
 {
@@ -29,18 +30,107 @@ namespace Papyrus
 			return;
 		}
 
-		manager->toggleEffect(effectName.c_str(), state);
+		manager->toggleEffect(effectName.c_str(), state, Journal::Source::Papyrus);
 	}
 
 	void ToggleReShade(VM* vm, StackID stackID, RE::StaticFunctionTag*, bool state)
 	{
-		if (!Manager::GetSingleton()->isReShadeInstalled())
+		const auto manager = Manager::GetSingleton();
+		if (!manager->isReShadeInstalled())
+		{
+			vm->TraceStack("ReShade with full add-on support not installed!", stackID);
+			return;
+		}
+
+		manager->toggleReshade(state, Journal::Source::Papyrus);
+	}
+
+	void ToggleEffects(VM* vm, StackID stackID, RE::StaticFunctionTag*, std::vector<RE::BSFixedString> effectNames, std::vector<bool> states)
+	{
+		const auto manager = Manager::GetSingleton();
+		if (!manager->isReShadeInstalled())
+		{
+			vm->TraceStack("ReShade with full add-on support not installed!", stackID);
+			return;
+		}
+
+		if (effectNames.size() != states.size())
+		{
+			vm->TraceStack("ToggleEffects: effect names and states need to have the same length!", stackID);
+			return;
+		}
+
+		// all toggles end up in the same command batch and are applied together on the next frame
+		for (size_t i = 0; i < effectNames.size(); i++)
+		{
+			const char* effectName = effectNames[i].c_str();
+			if (strcmp(effectName, "EntireReShade") != 0 && !manager->effectExists(effectName))
+			{
+				const auto message = std::format("ReShade effect {} not found!", effectName);
+				vm->TraceStack(message.c_str(), stackID);
+				continue;
+			}
+
+			manager->toggleEffect(effectName, states[i], Journal::Source::Papyrus);
+		}
+	}
+
+	void SetUniformFloat(VM* vm, StackID stackID, RE::StaticFunctionTag*, RE::BSFixedString effectName, RE::BSFixedString uniformName, std::vector<float> values)
+	{
+		const auto manager = Manager::GetSingleton();
+		if (!manager->isReShadeInstalled())
 		{
 			vm->TraceStack("ReShade with full add-on support not installed!", stackID);
 			return;
 		}
 
-		s_pRuntime->set_effects_state(state);
+		if (!manager->effectExists(effectName.c_str()))
+		{
+			const auto message = std::format("ReShade effect {} not found!", effectName.c_str());
+			vm->TraceStack(message.c_str(), stackID);
+			return;
+		}
+
+		if (values.empty() || values.size() > 4)
+		{
+			vm->TraceStack("SetUniformFloat: expected between 1 and 4 values!", stackID);
+			return;
+		}
+
+		CommandQueue::GetSingleton()->pushSetUniform<float>(EffectTable::GetSingleton()->intern(effectName.c_str()), uniformName.c_str(), values.data(), values.size(), Journal::Source::Papyrus, 0);
+	}
+
+	bool ApplyProfile(VM* vm, StackID stackID, RE::StaticFunctionTag*, RE::BSFixedString presetName)
+	{
+		const auto manager = Manager::GetSingleton();
+		if (!manager->isReShadeInstalled())
+		{
+			vm->TraceStack("ReShade with full add-on support not installed!", stackID);
+			return false;
+		}
+
+		std::string preset = presetName.c_str();
+		if (!preset.ends_with(".json"))
+		{
+			preset += ".json";
+		}
+
+		if (!std::filesystem::exists(manager->getPresetPath(preset)))
+		{
+			const auto message = std::format("Preset {} not found!", preset);
+			vm->TraceStack(message.c_str(), stackID);
+			return false;
+		}
+
+		// parsed on the game thread like every other preset switch, so the overlay and the INI follow it
+		SKSE::GetTaskInterface()->AddTask([preset]() {
+			if (!Menu::GetSingleton()->loadPreset(preset))
+			{
+				SKSE::log::error("ApplyProfile: failed to load preset {}", preset);
+			}
+			});
+
+		return true;
 	}
 
 	bool Bind(VM* vm)
@@ -56,6 +146,9 @@ namespace Papyrus
 		vm->RegisterFunction("ToggleEffect"sv, className, ToggleEffect, true);
 		vm->RegisterFunction("IsReShadeInstalled"sv, className, IsReShadeInstalled, true);
 		vm->RegisterFunction("ToggleReShade"sv, className, ToggleReShade, true);
+		vm->RegisterFunction("ToggleEffects"sv, className, ToggleEffects, true);
+		vm->RegisterFunction("SetUniformFloat"sv, className, SetUniformFloat, true);
+		vm->RegisterFunction("ApplyProfile"sv, className, ApplyProfile, true);
 		vm->RegisterFunction("GetVersion"sv, className, GetVersion, true);
 		return true;
 	}
@@ -0,0 +1,27 @@
+#include "PassFingerprint.h"
+
+bool PassFingerprint::matches(const Value& value)
+{
+	if (value == m_previous)
+	{
+		m_hits.fetch_add(1, std::memory_order_relaxed);
+		return true;
+	}
+
+	m_previous = value;
+	m_misses.fetch_add(1, std::memory_order_relaxed);
+	return false;
+}
+
+float PassFingerprint::getHitRate() const
+{
+	const std::uint64_t hits = getHits();
+	const std::uint64_t total = hits + getMisses();
+	return total > 0 ? static_cast<float>(hits) / total : 0.f;
+}
+
+void PassFingerprint::resetCounters()
+{
+	m_hits.store(0, std::memory_order_relaxed);
+	m_misses.store(0, std::memory_order_relaxed);
+}
@@ -0,0 +1,137 @@
+#include "Profiler.h"
+
+#ifdef ENABLE_PROFILER
+
+const char* Profiler::getZoneName(Zone zone)
+{
+	switch (zone)
+	{
+	case Zone::MainUpdate: return "Hook::MainUpdate";
+	case Zone::ProcessEvent: return "Event::ProcessEvent";
+	case Zone::ToggleEffectMenu: return "Manager::toggleEffectMenu";
+	case Zone::ToggleEffectWeather: return "Manager::toggleEffectWeather";
+	case Zone::ToggleEffectTime: return "Manager::toggleEffectTime";
+	case Zone::ToggleEffectInterior: return "Manager::toggleEffectInterior";
+	case Zone::ToggleEffectRules: return "Manager::toggleEffectRules";
+	case Zone::ToggleEffect: return "Manager::toggleEffect";
+	case Zone::ParsePreset: return "Manager::parseJSONPreset";
+	case Zone::SerializePreset: return "Manager::serializeJSONPreset";
+	case Zone::SettingsMenu: return "Menu::SettingsMenu";
+	case Zone::ExecuteCommands: return "Manager::executeCommands";
+	case Zone::AnimateUniforms: return "UniformAnimator::update";
+	case Zone::UpdateTransitions: return "UniformTransitions::update";
+	case Zone::EvaluateBindings: return "UniformBindings::update";
+	default: return "Unknown";
+	}
+}
+
+Profiler::ThreadBuffer* Profiler::getThreadBuffer()
+{
+	// worker threads come and go (compile pool, benchmarks), their buffers are handed back on exit
+	struct Owner
+	{
+		ThreadBuffer* buffer = nullptr;
+		~Owner()
+		{
+			if (buffer)
+			{
+				buffer->retired.store(true, std::memory_order_release);
+			}
+		}
+	};
+	thread_local Owner owner;
+
+	if (!owner.buffer)
+	{
+		std::scoped_lock lock(m_registryLock);
+		owner.buffer = m_threadBuffers.emplace_back(std::make_unique<ThreadBuffer>()).get();
+	}
+
+	return owner.buffer;
+}
+
+void Profiler::record(Zone zone, std::chrono::steady_clock::duration duration)
+{
+	ThreadBuffer* buffer = getThreadBuffer();
+
+	const std::uint32_t head = buffer->head.load(std::memory_order_relaxed);
+	const std::uint32_t tail = buffer->tail.load(std::memory_order_acquire);
+
+	if (head - tail >= s_threadBufferSize)
+	{
+		m_droppedSamples.fetch_add(1, std::memory_order_relaxed);
+		return;
+	}
+
+	const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count();
+	buffer->samples[head & (s_threadBufferSize - 1)] = { zone, static_cast<std::uint32_t>(std::min<long long>(ns, UINT32_MAX)) };
+	buffer->head.store(head + 1, std::memory_order_release);
+}
+
+void Profiler::collect()
+{
+	std::scoped_lock lock(m_registryLock);
+
+	std::erase_if(m_threadBuffers, [this](const std::unique_ptr<ThreadBuffer>& buffer) {
+		// read before draining, a retired thread can't record anything after it
+		const bool retired = buffer->retired.load(std::memory_order_acquire);
+
+		const std::uint32_t head = buffer->head.load(std::memory_order_acquire);
+		std::uint32_t tail = buffer->tail.load(std::memory_order_relaxed);
+
+		for (; tail != head; ++tail)
+		{
+			const Sample& sample = buffer->samples[tail & (s_threadBufferSize - 1)];
+			if (sample.zone >= Zone::kTotal)
+				continue;
+
+			Window& window = m_windows[static_cast<std::size_t>(sample.zone)];
+			window.durationsNs[window.next] = sample.durationNs;
+			window.next = (window.next + 1) % s_windowSize;
+			window.count = std::min(window.count + 1, s_windowSize);
+		}
+
+		buffer->tail.store(tail, std::memory_order_release);
+		return retired;
+		});
+}
+
+Profiler::ZoneStats Profiler::getStats(Zone zone) const
+{
+	ZoneStats stats;
+	if (zone >= Zone::kTotal)
+		return stats;
+
+	const Window& window = m_windows[static_cast<std::size_t>(zone)];
+	if (window.count == 0)
+		return stats;
+
+	std::array<std::uint32_t, s_windowSize> sorted;
+	std::copy_n(window.durationsNs.begin(), window.count, sorted.begin());
+	const auto end = sorted.begin() + window.count;
+
+	std::uint64_t total = 0;
+	for (auto it = sorted.begin(); it != end; ++it)
+	{
+		total += *it;
+	}
+
+	const std::uint32_t p99Index = (window.count * 99) / 100;
+	std::nth_element(sorted.begin(), sorted.begin() + p99Index, end);
+
+	constexpr float nsToMs = 1.0f / 1'000'000.0f;
+	stats.p99Ms = sorted[p99Index] * nsToMs;
+	stats.minMs = *std::min_element(sorted.begin(), end) * nsToMs;
+	stats.avgMs = static_cast<float>(total) / window.count * nsToMs;
+	stats.sampleCount = window.count;
+
+	return stats;
+}
+
+void Profiler::reset()
+{
+	collect();
+	m_windows = {};
+	m_droppedSamples.store(0, std::memory_order_relaxed);
+}
+#endif
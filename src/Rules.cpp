@@ -0,0 +1,361 @@
+#include "Rules.h"
+#include "Manager.h"
+
+#include <immintrin.h>
+#include <intrin.h>
+#include <random>
+
+namespace Rules
+{
+	namespace
+	{
+		void evaluateScalar(const RuleStore& store, const std::uint32_t state, std::span<std::uint64_t> results)
+		{
+			const auto mustMask = store.mustMask();
+			const auto mustValue = store.mustValue();
+			const auto hourMask = store.hourMask();
+			const auto weatherMask = store.weatherMask();
+
+			for (size_t i = 0; i < store.size(); i++)
+			{
+				const bool match = ((state & mustMask[i]) == mustValue[i]) & ((state & hourMask[i]) != 0) & ((state & weatherMask[i]) != 0);
+				results[i / 64] |= static_cast<std::uint64_t>(match) << (i % 64);
+			}
+		}
+
+		// 4 rules per instruction
+		void evaluateSSE2(const RuleStore& store, const std::uint32_t state, std::span<std::uint64_t> results)
+		{
+			const __m128i stateVec = _mm_set1_epi32(static_cast<int>(state));
+			const __m128i zero = _mm_setzero_si128();
+
+			for (size_t i = 0; i < store.size(); i += 4)
+			{
+				const __m128i mustMask = _mm_loadu_si128(reinterpret_cast<const __m128i*>(store.mustMask() + i));
+				const __m128i mustValue = _mm_loadu_si128(reinterpret_cast<const __m128i*>(store.mustValue() + i));
+				const __m128i hourMask = _mm_loadu_si128(reinterpret_cast<const __m128i*>(store.hourMask() + i));
+				const __m128i weatherMask = _mm_loadu_si128(reinterpret_cast<const __m128i*>(store.weatherMask() + i));
+
+				const __m128i mustOk = _mm_cmpeq_epi32(_mm_and_si128(stateVec, mustMask), mustValue);
+				const __m128i hourMiss = _mm_cmpeq_epi32(_mm_and_si128(stateVec, hourMask), zero);
+				const __m128i weatherMiss = _mm_cmpeq_epi32(_mm_and_si128(stateVec, weatherMask), zero);
+				const __m128i match = _mm_andnot_si128(_mm_or_si128(hourMiss, weatherMiss), mustOk);
+
+				const auto bits = static_cast<std::uint64_t>(_mm_movemask_ps(_mm_castsi128_ps(match)));
+				results[i / 64] |= bits << (i % 64);
+			}
+		}
+
+		// 8 rules per instruction
+		void evaluateAVX2(const RuleStore& store, const std::uint32_t state, std::span<std::uint64_t> results)
+		{
+			const __m256i stateVec = _mm256_set1_epi32(static_cast<int>(state));
+			const __m256i zero = _mm256_setzero_si256();
+
+			for (size_t i = 0; i < store.size(); i += 8)
+			{
+				const __m256i mustMask = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(store.mustMask() + i));
+				const __m256i mustValue = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(store.mustValue() + i));
+				const __m256i hourMask = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(store.hourMask() + i));
+				const __m256i weatherMask = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(store.weatherMask() + i));
+
+				const __m256i mustOk = _mm256_cmpeq_epi32(_mm256_and_si256(stateVec, mustMask), mustValue);
+				const __m256i hourMiss = _mm256_cmpeq_epi32(_mm256_and_si256(stateVec, hourMask), zero);
+				const __m256i weatherMiss = _mm256_cmpeq_epi32(_mm256_and_si256(stateVec, weatherMask), zero);
+				const __m256i match = _mm256_andnot_si256(_mm256_or_si256(hourMiss, weatherMiss), mustOk);
+
+				const auto bits = static_cast<std::uint64_t>(_mm256_movemask_ps(_mm256_castsi256_ps(match)));
+				results[i / 64] |= bits << (i % 64);
+			}
+		}
+
+		bool isAVX2Supported()
+		{
+			int info[4] = {};
+			__cpuid(info, 0);
+			if (info[0] < 7)
+				return false;
+
+			__cpuid(info, 1);
+			const bool osxsave = (info[2] & (1 << 27)) != 0;
+			const bool avx = (info[2] & (1 << 28)) != 0;
+			if (!osxsave || !avx)
+				return false;
+
+			// the OS has to save the YMM registers on context switches
+			if ((_xgetbv(0) & 0x6) != 0x6)
+				return false;
+
+			__cpuidex(info, 7, 0);
+			return (info[1] & (1 << 5)) != 0;
+		}
+	}
+
+	void RuleStore::clear()
+	{
+		m_count = 0;
+		m_mustMask.clear();
+		m_mustValue.clear();
+		m_hourMask.clear();
+		m_weatherMask.clear();
+	}
+
+	void RuleStore::reserve(size_t count)
+	{
+		const size_t padded = (count + s_lanes - 1) / s_lanes * s_lanes;
+		m_mustMask.reserve(padded);
+		m_mustValue.reserve(padded);
+		m_hourMask.reserve(padded);
+		m_weatherMask.reserve(padded);
+	}
+
+	void RuleStore::add(const CompiledRule& rule)
+	{
+		// drop the padding of the previous add
+		m_mustMask.resize(m_count);
+		m_mustValue.resize(m_count);
+		m_hourMask.resize(m_count);
+		m_weatherMask.resize(m_count);
+
+		m_mustMask.emplace_back(rule.mustMask);
+		m_mustValue.emplace_back(rule.mustValue);
+		m_hourMask.emplace_back(rule.hourMask);
+		m_weatherMask.emplace_back(rule.weatherMask);
+		m_count++;
+
+		pad();
+	}
+
+	void RuleStore::pad()
+	{
+		// an empty hour mask never matches
+		const size_t padded = (m_count + s_lanes - 1) / s_lanes * s_lanes;
+		m_mustMask.resize(padded, 0);
+		m_mustValue.resize(padded, 0);
+		m_hourMask.resize(padded, 0);
+		m_weatherMask.resize(padded, 0);
+	}
+
+	std::uint32_t captureGameState()
+	{
+		std::uint32_t state = 0;
+
+		if (const auto calendar = RE::Calendar::GetSingleton())
+		{
+			const auto hour = std::clamp(static_cast<int>(calendar->GetHour()), 0, 23);
+			state |= 1u << (kHour + hour);
+		}
+
+		if (const auto player = RE::PlayerCharacter::GetSingleton())
+		{
+			const auto cell = player->GetParentCell();
+			if (cell && cell->IsInteriorCell())
+			{
+				state |= 1u << kInterior;
+			}
+		}
+
+		if (const auto ui = RE::UI::GetSingleton(); ui && ui->GameIsPaused())
+		{
+			state |= 1u << kInMenu;
+		}
+
+		if (const auto sky = RE::Sky::GetSingleton(); sky && sky->currentWeather)
+		{
+			using Flag = RE::TESWeather::WeatherDataFlag;
+			const auto& flags = sky->currentWeather->data.flags;
+
+			if (flags.any(Flag::kPleasant))
+				state |= 1u << kPleasant;
+			if (flags.any(Flag::kCloudy))
+				state |= 1u << kCloudy;
+			if (flags.any(Flag::kRainy))
+				state |= 1u << kRainy;
+			if (flags.any(Flag::kSnow))
+				state |= 1u << kSnow;
+		}
+
+		if ((state & kWeatherBits) == 0)
+		{
+			state |= 1u << kNoWeatherClass;
+		}
+
+		return state;
+	}
+
+	CompiledRule compile(const RuleToggleInformation& rule)
+	{
+		CompiledRule compiled;
+
+		// [start, stop) in hours, wrapping past midnight; start == stop means the whole day
+		const int start = std::clamp(rule.startHour, 0, 24) % 24;
+		const int stop = std::clamp(rule.stopHour, 0, 24) % 24;
+		if (start != stop)
+		{
+			compiled.hourMask = 0;
+			for (int hour = start; hour != stop; hour = (hour + 1) % 24)
+			{
+				compiled.hourMask |= 1u << (kHour + hour);
+			}
+		}
+
+		if (rule.location == "Interior" || rule.location == "Exterior")
+		{
+			compiled.mustMask |= 1u << kInterior;
+			compiled.mustValue |= rule.location == "Interior" ? 1u << kInterior : 0;
+		}
+
+		if (rule.menu == "Open" || rule.menu == "Closed")
+		{
+			compiled.mustMask |= 1u << kInMenu;
+			compiled.mustValue |= rule.menu == "Open" ? 1u << kInMenu : 0;
+		}
+
+		std::uint32_t weatherMask = 0;
+		for (const auto& weather : rule.weathers)
+		{
+			const auto it = std::find(s_weatherOptions.begin(), s_weatherOptions.end(), weather);
+			if (it == s_weatherOptions.end())
+			{
+				SKSE::log::warn("Unknown weather class '{}' in rule for {}", weather, rule.effectName);
+				continue;
+			}
+
+			weatherMask |= 1u << (kPleasant + std::distance(s_weatherOptions.begin(), it));
+		}
+
+		if (weatherMask != 0)
+		{
+			compiled.weatherMask = weatherMask;
+		}
+
+		return compiled;
+	}
+
+	Evaluator getBestEvaluator()
+	{
+		static const Evaluator best = isAVX2Supported() ? Evaluator::AVX2 : Evaluator::SSE2;
+		return best;
+	}
+
+	const char* getEvaluatorName(Evaluator evaluator)
+	{
+		switch (evaluator)
+		{
+		case Evaluator::Scalar: return "Scalar";
+		case Evaluator::SSE2: return "SSE2";
+		case Evaluator::AVX2: return "AVX2";
+		default: return "Unknown";
+		}
+	}
+
+	void evaluate(const RuleStore& store, const std::uint32_t state, std::span<std::uint64_t> results, Evaluator evaluator)
+	{
+		std::fill(results.begin(), results.end(), 0);
+
+		switch (evaluator)
+		{
+		case Evaluator::AVX2:
+			evaluateAVX2(store, state, results);
+			break;
+		case Evaluator::SSE2:
+			evaluateSSE2(store, state, results);
+			break;
+		default:
+			evaluateScalar(store, state, results);
+			break;
+		}
+
+		// the SIMD paths also evaluate the never-matching padding, clear anything past the last rule
+		if (const size_t tail = store.size() % 64; tail != 0 && !results.empty())
+		{
+			results.back() &= (1ull << tail) - 1;
+		}
+	}
+
+	std::vector<BenchmarkResult> runBenchmark()
+	{
+		std::vector<BenchmarkResult> benchmarks;
+		std::mt19937 rng(1337);
+
+		for (const size_t ruleCount : { 1'000, 10'000, 100'000 })
+		{
+			RuleStore store;
+			store.reserve(ruleCount);
+			for (size_t i = 0; i < ruleCount; i++)
+			{
+				CompiledRule rule;
+				rule.mustMask = rng() & ((1u << kInterior) | (1u << kInMenu));
+				rule.mustValue = rng() & rule.mustMask;
+				rule.hourMask = (rng() & kHourBits) | 1u;
+				rule.weatherMask = (rng() & kWeatherBits) | (1u << kNoWeatherClass);
+				store.add(rule);
+			}
+
+			std::vector<std::uint64_t> reference(store.resultWords());
+			std::vector<std::uint64_t> results(store.resultWords());
+
+			// enough iterations for a stable average without keeping the overlay waiting for long
+			const int iterations = static_cast<int>(std::max<size_t>(10, 2'000'000 / ruleCount));
+
+			BenchmarkResult result;
+			result.ruleCount = ruleCount;
+
+			auto measure = [&](Evaluator evaluator, std::vector<std::uint64_t>& out) {
+				const auto start = std::chrono::steady_clock::now();
+				for (int i = 0; i < iterations; i++)
+				{
+					evaluate(store, static_cast<std::uint32_t>(rng()), out, evaluator);
+				}
+				const auto end = std::chrono::steady_clock::now();
+				return std::chrono::duration<double, std::micro>(end - start).count() / iterations;
+				};
+
+			result.scalarUs = measure(Evaluator::Scalar, reference);
+			result.sseUs = measure(Evaluator::SSE2, results);
+			if (getBestEvaluator() == Evaluator::AVX2)
+			{
+				result.avxUs = measure(Evaluator::AVX2, results);
+			}
+
+			// every state captureGameState can produce (one hour, one weather class, both flags),
+			// followed by raw random words so bits outside a valid state are covered as well
+			std::vector<std::uint32_t> states;
+			for (std::uint32_t hour = 0; hour < 24; hour++)
+			{
+				for (std::uint32_t weather = kPleasant; weather <= kNoWeatherClass; weather++)
+				{
+					for (std::uint32_t flags = 0; flags < 4; flags++)
+					{
+						states.push_back((1u << hour) | (1u << weather) | (flags << kInterior));
+					}
+				}
+			}
+			for (int i = 0; i < 256; i++)
+			{
+				states.push_back(static_cast<std::uint32_t>(rng()));
+			}
+
+			for (const auto state : states)
+			{
+				evaluate(store, state, reference, Evaluator::Scalar);
+
+				evaluate(store, state, results, Evaluator::SSE2);
+				result.resultsMatch &= results == reference;
+
+				if (getBestEvaluator() == Evaluator::AVX2)
+				{
+					evaluate(store, state, results, Evaluator::AVX2);
+					result.resultsMatch &= results == reference;
+				}
+
+				if (!result.resultsMatch)
+					break;
+			}
+
+			benchmarks.emplace_back(result);
+		}
+
+		return benchmarks;
+	}
+}
@@ -0,0 +1,85 @@
+#include "RuntimeRegistry.h"
+#include "Manager.h"
+
+const std::vector<reshade::api::effect_technique>& RuntimeRegistry::Entry::getTechniques(EffectTable::ID effect)
+{
+	if (effect >= techniques.size())
+	{
+		techniques.resize(EffectTable::GetSingleton()->size());
+		techniquesResolved.resize(techniques.size(), false);
+	}
+
+	if (!techniquesResolved[effect])
+	{
+		runtime->enumerate_techniques(EffectTable::GetSingleton()->getName(effect), [&](reshade::api::effect_runtime*, reshade::api::effect_technique technique) {
+			techniques[effect].emplace_back(technique);
+			});
+		techniquesResolved[effect] = true;
+	}
+
+	return techniques[effect];
+}
+
+RuntimeRegistry::Entry::Uniform& RuntimeRegistry::Entry::getUniform(EffectTable::ID effect, const char* uniform)
+{
+	const char* effectName = EffectTable::GetSingleton()->getName(effect);
+
+	std::string key = std::format("{}|{}", effectName, uniform);
+	if (const auto it = uniforms.find(key); it != uniforms.end())
+		return it->second;
+
+	Uniform resolved;
+	resolved.variable = runtime->find_uniform_variable(effectName, uniform);
+	return uniforms.emplace(std::move(key), resolved).first->second;
+}
+
+void RuntimeRegistry::add(reshade::api::effect_runtime* runtime)
+{
+	std::scoped_lock lock(m_lock);
+
+	const auto it = std::find_if(m_entries.begin(), m_entries.end(), [runtime](const auto& entry) { return entry->runtime == runtime; });
+	if (it != m_entries.end())
+		return;
+
+	auto& entry = m_entries.emplace_back(std::make_unique<Entry>());
+	entry->runtime = runtime;
+
+	SKSE::log::info("Effect runtime {} initialized, {} active", static_cast<void*>(runtime), m_entries.size());
+}
+
+void RuntimeRegistry::remove(reshade::api::effect_runtime* runtime)
+{
+	std::scoped_lock lock(m_lock);
+
+	std::erase_if(m_entries, [runtime](const auto& entry) { return entry->runtime == runtime; });
+
+	SKSE::log::info("Effect runtime {} destroyed, {} active", static_cast<void*>(runtime), m_entries.size());
+}
+
+void RuntimeRegistry::invalidate(reshade::api::effect_runtime* runtime)
+{
+	std::scoped_lock lock(m_lock);
+
+	for (auto& entry : m_entries)
+	{
+		if (entry->runtime == runtime)
+		{
+			entry->techniques.clear();
+			entry->techniquesResolved.clear();
+			entry->uniforms.clear();
+			entry->prewarmed.clear();
+		}
+	}
+}
+
+reshade::api::effect_runtime* RuntimeRegistry::getPrimary() const
+{
+	std::scoped_lock lock(m_lock);
+	return m_entries.empty() ? nullptr : m_entries.front()->runtime;
+}
+
+size_t RuntimeRegistry::size() const
+{
+	std::scoped_lock lock(m_lock);
+	return m_entries.size();
+}
@@ -0,0 +1,120 @@
+#include "StateSnapshot.h"
+#include "Manager.h"
+
+StateSnapshot::StateSnapshot(RuntimeRegistry::Entry& entry) : m_entry(entry)
+{
+	const auto runtime = entry.runtime;
+	const size_t count = EffectTable::GetSingleton()->size();
+
+	m_effectsState = runtime->get_effects_state();
+	m_techniques.resize(count, s_unknownState);
+	m_latestToggle.resize(count, -1);
+
+	for (size_t effect = 0; effect < count; effect++)
+	{
+		const auto& techniques = entry.getTechniques(static_cast<EffectTable::ID>(effect));
+		if (techniques.empty())
+			continue;
+
+		const bool first = runtime->get_technique_state(techniques.front());
+		const bool mixed = std::any_of(techniques.begin() + 1, techniques.end(), [&](const auto technique) {
+			return runtime->get_technique_state(technique) != first;
+			});
+		m_techniques[effect] = mixed ? s_mixedState : static_cast<std::uint8_t>(first);
+	}
+}
+
+void StateSnapshot::fold(const CommandQueue::Command& command)
+{
+	const auto index = static_cast<std::int32_t>(m_commands.size());
+	m_commands.push_back({ command });
+	Folded& folded = m_commands.back();
+
+	switch (command.type)
+	{
+	case CommandQueue::Type::ToggleEffect:
+	{
+		if (command.effect >= m_techniques.size()) // interned after the snapshot was taken
+			break;
+
+		auto& latest = m_latestToggle[command.effect];
+		if (latest >= 0)
+		{
+			m_commands[latest].superseded = true;
+		}
+		latest = index;
+
+		const auto state = m_techniques[command.effect];
+		folded.changes = state == s_mixedState || (state != s_unknownState && state != static_cast<std::uint8_t>(command.state));
+	}
+	break;
+	case CommandQueue::Type::ToggleReShade:
+	{
+		if (m_latestReShade >= 0)
+		{
+			m_commands[m_latestReShade].superseded = true;
+		}
+		m_latestReShade = index;
+
+		folded.changes = m_effectsState != command.state;
+	}
+	break;
+	case CommandQueue::Type::SetUniform:
+	case CommandQueue::Type::RestoreUniform:
+	{
+		const auto [it, inserted] = m_uniforms.try_emplace(std::format("{}|{}", command.effect, command.uniform));
+		Uniform& uniform = it->second;
+		if (!inserted)
+		{
+			m_commands[uniform.latest].superseded = true;
+			uniform.touched = true;
+		}
+		uniform.latest = index;
+
+		if (command.type == CommandQueue::Type::SetUniform)
+		{
+			folded.changes = !holds(uniform, command, command.valueType, command.valueCount, command.values);
+			break;
+		}
+
+		const auto handle = command.baseline;
+		if (handle < m_entry.baselines.size() && m_entry.baselines[handle].captured)
+		{
+			const auto& baseline = m_entry.baselines[handle];
+			folded.changes = !holds(uniform, command, baseline.valueType, baseline.valueCount, baseline.values);
+		}
+		else
+		{
+			// never overridden on this runtime, only reset if this batch didn't drop the override it undoes
+			folded.changes = !uniform.touched;
+		}
+	}
+	break;
+	case CommandQueue::Type::PrewarmEffect:
+		break;
+	}
+}
+
+bool StateSnapshot::holds(Uniform& uniform, const CommandQueue::Command& command, Journal::ValueType valueType, std::uint8_t valueCount, const std::uint32_t* values)
+{
+	if (valueType == Journal::ValueType::None || valueCount == 0)
+		return false;
+
+	if (!uniform.captured || uniform.valueType != valueType || uniform.valueCount < valueCount)
+	{
+		auto& resolved = m_entry.getUniform(command.effect, command.uniform);
+		if (resolved.variable.handle == 0)
+			return false;
+
+		Manager::GetSingleton()->getUniformBits(resolved.variable, valueType, uniform.values, valueCount, m_entry.runtime);
+		uniform.captured = true;
+		uniform.valueType = valueType;
+		uniform.valueCount = valueCount;
+
+		// the journal's old value when the command is applied
+		resolved.current = { true, valueType, valueCount };
+		std::copy_n(uniform.values, 4, resolved.current.values);
+	}
+
+	return std::equal(values, values + valueCount, uniform.values);
+}
@@ -0,0 +1,71 @@
+#include "TickScheduler.h"
+
+const char* TickScheduler::getPassName(Pass pass)
+{
+	switch (pass)
+	{
+	case Pass::Weather: return "Weather";
+	case Pass::Time: return "Time";
+	case Pass::Rules: return "Rules";
+	default: return "Unknown";
+	}
+}
+
+bool TickScheduler::isDue(Pass pass, Clock::time_point now) const
+{
+	std::scoped_lock lock(m_lock);
+	return now.time_since_epoch().count() >= m_due[static_cast<size_t>(pass)];
+}
+
+void TickScheduler::schedule(Pass pass, Clock::time_point now, Clock::duration delay)
+{
+	std::scoped_lock lock(m_lock);
+
+	Clock::rep due = std::numeric_limits<Clock::rep>::max();
+	if (delay != s_never)
+	{
+		const auto clamped = std::clamp<Clock::duration>(delay, m_minInterval, m_maxInterval);
+		due = (now + clamped).time_since_epoch().count();
+	}
+
+	m_due[static_cast<size_t>(pass)] = due;
+	updateNextDue();
+}
+
+void TickScheduler::wake(Pass pass)
+{
+	std::scoped_lock lock(m_lock);
+	m_due[static_cast<size_t>(pass)] = 0;
+	updateNextDue();
+}
+
+void TickScheduler::wakeAll()
+{
+	std::scoped_lock lock(m_lock);
+	m_due.fill(0);
+	updateNextDue();
+}
+
+long long TickScheduler::getRemainingMs(Pass pass, Clock::time_point now) const
+{
+	std::scoped_lock lock(m_lock);
+
+	const auto due = m_due[static_cast<size_t>(pass)];
+	if (due == std::numeric_limits<Clock::rep>::max())
+		return -1;
+
+	const auto remaining = Clock::duration(std::max<Clock::rep>(due - now.time_since_epoch().count(), 0));
+	return std::chrono::duration_cast<std::chrono::milliseconds>(remaining).count();
+}
+
+void TickScheduler::setIntervals(std::chrono::milliseconds minInterval, std::chrono::milliseconds maxInterval)
+{
+	std::scoped_lock lock(m_lock);
+	m_minInterval = std::max(minInterval, std::chrono::milliseconds(1));
+	m_maxInterval = std::max(maxInterval, m_minInterval);
+}
+
+void TickScheduler::updateNextDue()
+{
+	m_nextDue.store(*std::min_element(m_due.begin(), m_due.end()), std::memory_order_release);
+}
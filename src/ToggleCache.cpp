@@ -0,0 +1,49 @@
+#include "ToggleCache.h"
+
+void ToggleCache::activate(std::uint64_t ruleID, EffectTable::ID effect, bool state)
+{
+	if (ruleID >= m_slots.size())
+	{
+		m_slots.resize(std::max<size_t>(ruleID + 1, m_slots.size() * 2), 0);
+	}
+
+	std::uint32_t& slot = m_slots[ruleID];
+	if (slot != 0)
+	{
+		Entry& entry = m_entries[slot - 1];
+		entry.effect = effect;
+		entry.state = state;
+		return;
+	}
+
+	m_entries.push_back({ ruleID, effect, state });
+	slot = static_cast<std::uint32_t>(m_entries.size());
+}
+
+void ToggleCache::release(std::uint64_t ruleID)
+{
+	if (!isActive(ruleID))
+		return;
+
+	const std::uint32_t index = m_slots[ruleID] - 1;
+	if (index + 1 != m_entries.size())
+	{
+		// swap the last entry into the hole
+		m_entries[index] = m_entries.back();
+		m_slots[m_entries[index].ruleID] = index + 1;
+	}
+
+	m_entries.pop_back();
+	m_slots[ruleID] = 0;
+}
+
+void ToggleCache::clear()
+{
+	for (const auto& entry : m_entries)
+	{
+		m_slots[entry.ruleID] = 0;
+	}
+
+	m_entries.clear();
+	m_form = nullptr;
+}
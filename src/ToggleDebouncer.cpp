@@ -0,0 +1,105 @@
+#include "ToggleDebouncer.h"
+#include "CommandQueue.h"
+
+bool ToggleDebouncer::request(EffectTable::ID effect, bool state, Journal::Source source, std::uint64_t ruleID, const ToggleTiming& timing)
+{
+	if (effect >= EffectTable::s_capacity)
+		return true;
+
+	const auto now = Clock::now();
+
+	std::scoped_lock lock(m_lock);
+
+	if (effect >= m_slots.size())
+	{
+		m_slots.resize(effect + 1);
+	}
+
+	Slot& slot = m_slots[effect];
+
+	// whatever was pending is replaced, flipping back before it was due means it never happens
+	if (slot.pending)
+	{
+		cancel(slot);
+		if (!timing.isImmediate() && state == slot.applied)
+		{
+			m_cancelledCount.fetch_add(1, std::memory_order_relaxed);
+			return false;
+		}
+	}
+
+	Clock::time_point due = now;
+	if (!timing.isImmediate() && slot.known && state != slot.applied)
+	{
+		due = std::max(now + std::chrono::milliseconds(timing.debounceMs), slot.appliedAt + std::chrono::milliseconds(timing.minDurationMs));
+	}
+
+	if (due <= now)
+	{
+		if (!slot.known || slot.applied != state)
+		{
+			slot.appliedAt = now;
+		}
+		slot.known = true;
+		slot.applied = state;
+		return true;
+	}
+
+	slot.pending = true;
+	slot.pendingState = state;
+	slot.source = source;
+	slot.ruleID = ruleID;
+	slot.generation++;
+	m_pendingCount.fetch_add(1, std::memory_order_relaxed);
+
+	m_timers.push({ due, effect, slot.generation });
+	m_nextDue.store(m_timers.top().due.time_since_epoch().count(), std::memory_order_release);
+	return false;
+}
+
+void ToggleDebouncer::update()
+{
+	const auto now = Clock::now();
+	if (now.time_since_epoch().count() < m_nextDue.load(std::memory_order_acquire))
+		return;
+
+	std::scoped_lock lock(m_lock);
+
+	while (!m_timers.empty() && m_timers.top().due <= now)
+	{
+		const Timer timer = m_timers.top();
+		m_timers.pop();
+
+		Slot& slot = m_slots[timer.effect];
+		if (!slot.pending || slot.generation != timer.generation)
+			continue; // replaced or cancelled
+
+		slot.pending = false;
+		slot.known = true;
+		slot.applied = slot.pendingState;
+		slot.appliedAt = now;
+		m_pendingCount.fetch_sub(1, std::memory_order_relaxed);
+
+		CommandQueue::GetSingleton()->pushToggleEffect(timer.effect, slot.pendingState, slot.source, slot.ruleID);
+	}
+
+	m_nextDue.store(m_timers.empty() ? std::numeric_limits<Clock::rep>::max() : m_timers.top().due.time_since_epoch().count(), std::memory_order_release);
+}
+
+void ToggleDebouncer::clear()
+{
+	std::scoped_lock lock(m_lock);
+
+	m_slots.clear();
+	m_timers = {};
+	m_nextDue.store(std::numeric_limits<Clock::rep>::max(), std::memory_order_release);
+	m_pendingCount.store(0, std::memory_order_relaxed);
+}
+
+void ToggleDebouncer::cancel(Slot& slot)
+{
+	// the timer stays in the heap until it reaches the top
+	slot.pending = false;
+	slot.generation++;
+	m_pendingCount.fetch_sub(1, std::memory_order_relaxed);
+}
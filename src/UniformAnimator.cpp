@@ -0,0 +1,175 @@
+#include "UniformAnimator.h"
+#include "CommandQueue.h"
+#include "Profiler.h"
+
+UniformAnimator::Interpolation UniformAnimator::getInterpolation(std::string_view name)
+{
+	return name == "Cubic" ? Interpolation::Cubic : Interpolation::Linear;
+}
+
+std::shared_ptr<const UniformAnimator::Curve> UniformAnimator::buildCurve(const std::vector<Keyframe>& keyframes, Interpolation interpolation)
+{
+	std::vector<Keyframe> sorted;
+	sorted.reserve(keyframes.size());
+	for (const auto& keyframe : keyframes)
+	{
+		if (!keyframe.values.empty())
+		{
+			sorted.push_back({ std::clamp(keyframe.hour, 0.f, 24.f), keyframe.values });
+		}
+	}
+
+	if (sorted.empty())
+		return nullptr;
+
+	std::ranges::sort(sorted, {}, &Keyframe::hour);
+
+	auto curve = std::make_shared<Curve>();
+	size_t valueCount = 4;
+	for (const auto& keyframe : sorted)
+	{
+		valueCount = std::min(valueCount, keyframe.values.size());
+	}
+	curve->valueCount = static_cast<std::uint8_t>(valueCount);
+
+	const size_t count = sorted.size();
+	const auto at = [&](size_t index) -> const Keyframe& { return sorted[index % count]; };
+
+	for (std::uint32_t sample = 0; sample < s_samples; sample++)
+	{
+		const float hour = sample * 24.f / s_samples;
+
+		// segment [k, k + 1], the last one wraps into the first keyframe of the next day
+		size_t k = count - 1;
+		for (size_t i = 0; i + 1 < count; i++)
+		{
+			if (hour >= sorted[i].hour && hour < sorted[i + 1].hour)
+			{
+				k = i;
+				break;
+			}
+		}
+
+		const Keyframe& from = at(k);
+		const Keyframe& to = at(k + 1);
+		float span = to.hour - from.hour;
+		float offset = hour - from.hour;
+		if (span <= 0.f)
+			span += 24.f;
+		if (offset < 0.f)
+			offset += 24.f;
+
+		const float t = count > 1 && span > 0.f ? std::clamp(offset / span, 0.f, 1.f) : 0.f;
+
+		for (size_t v = 0; v < valueCount; v++)
+		{
+			const float p1 = from.values[v];
+			const float p2 = to.values[v];
+
+			if (interpolation == Interpolation::Cubic)
+			{
+				const float p0 = at(k + count - 1).values[v];
+				const float p3 = at(k + 2).values[v];
+				const float t2 = t * t;
+				const float t3 = t2 * t;
+				curve->table[sample][v] = 0.5f * ((2.f * p1) + (-p0 + p2) * t + (2.f * p0 - 5.f * p1 + 4.f * p2 - p3) * t2 + (-p0 + 3.f * p1 - 3.f * p2 + p3) * t3);
+			}
+			else
+			{
+				curve->table[sample][v] = p1 + (p2 - p1) * t;
+			}
+		}
+	}
+
+	return curve;
+}
+
+void UniformAnimator::bind(EffectTable::ID effect, const std::string& uniform, std::shared_ptr<const Curve> curve, Journal::Source source, std::uint64_t ruleID)
+{
+	if (!curve)
+	{
+		unbind(effect, uniform);
+		return;
+	}
+
+	std::scoped_lock lock(m_lock);
+
+	const auto it = std::ranges::find_if(m_bindings, [&](const Binding& binding) { return binding.effect == effect && binding.uniform == uniform; });
+	if (it != m_bindings.end())
+	{
+		// rules rebind every tick, keep the last written value so nothing is rewritten needlessly
+		if (it->curve != curve)
+		{
+			it->curve = std::move(curve);
+			it->written = false;
+		}
+		it->source = source;
+		it->ruleID = ruleID;
+		return;
+	}
+
+	m_bindings.push_back({ effect, uniform, std::move(curve), source, ruleID });
+	m_count.store(m_bindings.size(), std::memory_order_relaxed);
+}
+
+void UniformAnimator::unbind(EffectTable::ID effect, const std::string& uniform)
+{
+	if (size() == 0)
+		return;
+
+	std::scoped_lock lock(m_lock);
+
+	std::erase_if(m_bindings, [&](const Binding& binding) { return binding.effect == effect && binding.uniform == uniform; });
+	m_count.store(m_bindings.size(), std::memory_order_relaxed);
+}
+
+void UniformAnimator::clear()
+{
+	std::scoped_lock lock(m_lock);
+
+	m_bindings.clear();
+	m_count.store(0, std::memory_order_relaxed);
+}
+
+void UniformAnimator::update()
+{
+	if (size() == 0)
+		return;
+
+	const auto calendar = RE::Calendar::GetSingleton();
+	if (!calendar)
+		return;
+
+	PROFILE_ZONE(Profiler::Zone::AnimateUniforms);
+
+	const float position = std::clamp(calendar->GetHour(), 0.f, 24.f) / 24.f * s_samples;
+	const auto index = static_cast<std::uint32_t>(position) % s_samples;
+	const std::uint32_t next = (index + 1) % s_samples;
+	const float t = position - std::floor(position);
+	const float epsilon = getEpsilon();
+
+	const auto queue = CommandQueue::GetSingleton();
+
+	std::scoped_lock lock(m_lock);
+
+	for (auto& binding : m_bindings)
+	{
+		const auto& a = binding.curve->table[index];
+		const auto& b = binding.curve->table[next];
+
+		std::array<float, 4> values{};
+		bool changed = !binding.written;
+		for (std::uint8_t v = 0; v < binding.curve->valueCount; v++)
+		{
+			values[v] = a[v] + (b[v] - a[v]) * t;
+			changed |= std::abs(values[v] - binding.lastWritten[v]) > epsilon;
+		}
+
+		if (!changed)
+			continue;
+
+		queue->pushSetUniform<float>(binding.effect, binding.uniform.c_str(), values.data(), binding.curve->valueCount, binding.source, binding.ruleID);
+		binding.lastWritten = values;
+		binding.written = true;
+	}
+}
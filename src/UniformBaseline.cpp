@@ -0,0 +1,78 @@
+#include "UniformBaseline.h"
+#include "CommandQueue.h"
+#include "UniformAnimator.h"
+#include "UniformTransitions.h"
+#include "UniformBindings.h"
+
+UniformBaseline::Handle UniformBaseline::intern(EffectTable::ID effect, const std::string& uniform)
+{
+	std::string key = makeKey(effect, uniform);
+
+	{
+		std::shared_lock lock(m_handleLock);
+		if (const auto it = m_handles.find(key); it != m_handles.end())
+			return it->second;
+	}
+
+	std::unique_lock lock(m_handleLock);
+	const auto [it, inserted] = m_handles.try_emplace(std::move(key), static_cast<Handle>(m_uniforms.size()));
+	if (inserted)
+	{
+		m_uniforms.emplace_back(effect, uniform);
+		m_holders.push_back(0);
+	}
+
+	return it->second;
+}
+
+UniformBaseline::Handle UniformBaseline::find(EffectTable::ID effect, std::string_view uniform) const
+{
+	std::shared_lock lock(m_handleLock);
+
+	const auto it = m_handles.find(makeKey(effect, uniform));
+	return it != m_handles.end() ? it->second : s_invalidHandle;
+}
+
+void UniformBaseline::hold(std::uint64_t ruleID, EffectTable::ID effect, const std::string& uniform)
+{
+	std::scoped_lock lock(m_holdLock);
+
+	const Handle handle = intern(effect, uniform);
+
+	auto& held = m_heldBy[ruleID];
+	if (std::ranges::find(held, handle) != held.end())
+		return;
+
+	held.push_back(handle);
+	if (m_holders[handle]++ == 0)
+	{
+		m_heldCount.fetch_add(1, std::memory_order_relaxed);
+	}
+}
+
+void UniformBaseline::release(std::uint64_t ruleID)
+{
+	std::scoped_lock lock(m_holdLock);
+
+	const auto it = m_heldBy.find(ruleID);
+	if (it == m_heldBy.end())
+		return;
+
+	for (const Handle handle : it->second)
+	{
+		if (--m_holders[handle] != 0)
+			continue;
+
+		m_heldCount.fetch_sub(1, std::memory_order_relaxed);
+
+		// nothing may keep driving the uniform once it is restored
+		const auto& [effect, uniform] = m_uniforms[handle];
+		UniformAnimator::GetSingleton()->unbind(effect, uniform);
+		UniformBindings::GetSingleton()->unbind(effect, uniform);
+		UniformTransitions::GetSingleton()->cancel(effect, uniform);
+
+		CommandQueue::GetSingleton()->pushRestoreUniform(effect, uniform.c_str(), handle, ruleID);
+	}
+
+	m_heldBy.erase(it);
+}
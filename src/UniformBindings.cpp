@@ -0,0 +1,206 @@
+#include "UniformBindings.h"
+#include "CommandQueue.h"
+#include "Profiler.h"
+
+namespace
+{
+	// fraction of the permanent maximum
+	float getActorValuePercent(RE::ActorValue actorValue)
+	{
+		const auto player = RE::PlayerCharacter::GetSingleton();
+		const auto owner = player ? player->AsActorValueOwner() : nullptr;
+		if (!owner)
+			return 0.f;
+
+		const float maximum = owner->GetPermanentActorValue(actorValue);
+		return maximum > 0.f ? std::clamp(owner->GetActorValue(actorValue) / maximum, 0.f, 1.f) : 0.f;
+	}
+}
+
+float UniformBindings::readSource(const Source& source)
+{
+	switch (source.type)
+	{
+	case SourceType::Health: return getActorValuePercent(RE::ActorValue::kHealth);
+	case SourceType::Magicka: return getActorValuePercent(RE::ActorValue::kMagicka);
+	case SourceType::Stamina: return getActorValuePercent(RE::ActorValue::kStamina);
+	case SourceType::Submerged:
+	{
+		const auto player = RE::PlayerCharacter::GetSingleton();
+		return player ? player->GetSubmergedWaterLevel(player->GetPositionZ(), player->GetParentCell()) : 0.f;
+	}
+	case SourceType::Hour:
+	{
+		const auto calendar = RE::Calendar::GetSingleton();
+		return calendar ? calendar->GetHour() : 0.f;
+	}
+	case SourceType::Global: return source.global ? source.global->value : 0.f;
+	default: return 0.f;
+	}
+}
+
+void UniformBindings::bind(EffectTable::ID effect, const std::string& uniform, const UniformBinding& binding, Journal::Source source, std::uint64_t ruleID)
+{
+	std::scoped_lock lock(m_lock);
+
+	const auto it = std::ranges::find_if(m_bindings, [&](const Binding& existing) { return existing.effect == effect && existing.uniform == uniform; });
+	if (it != m_bindings.end())
+	{
+		// rules rebind every tick, only recompile when the expression actually changed
+		const auto& old = it->expression;
+		it->source = source;
+		it->ruleID = ruleID;
+		if (old.source == binding.source && old.global == binding.global && old.scale == binding.scale &&
+			old.offset == binding.offset && old.min == binding.min && old.max == binding.max)
+			return;
+
+		it->expression = binding;
+		it->written = false;
+	}
+	else
+	{
+		m_bindings.push_back({ effect, uniform, binding, source, ruleID });
+	}
+
+	compile();
+}
+
+void UniformBindings::unbind(EffectTable::ID effect, const std::string& uniform)
+{
+	if (size() == 0)
+		return;
+
+	std::scoped_lock lock(m_lock);
+
+	const auto removed = std::erase_if(m_bindings, [&](const Binding& binding) { return binding.effect == effect && binding.uniform == uniform; });
+	if (removed > 0)
+	{
+		compile();
+	}
+}
+
+void UniformBindings::clear()
+{
+	std::scoped_lock lock(m_lock);
+
+	m_bindings.clear();
+	compile();
+}
+
+void UniformBindings::compile()
+{
+	// keep the generations of sources that survive, so unchanged bindings aren't rewritten
+	std::vector<Source> sources;
+	sources.reserve(m_sources.size());
+
+	const auto findSlot = [&sources, this](SourceType type, RE::TESGlobal* global) -> std::uint16_t {
+		for (std::uint16_t i = 0; i < sources.size(); i++)
+		{
+			if (sources[i].type == type && sources[i].global == global)
+				return i;
+		}
+
+		Source source{ type, global };
+		for (const auto& old : m_sources)
+		{
+			if (old.type == type && old.global == global)
+			{
+				source = old;
+				break;
+			}
+		}
+		sources.push_back(source);
+		return static_cast<std::uint16_t>(sources.size() - 1);
+		};
+
+	m_program.clear();
+	std::erase_if(m_bindings, [](const Binding& binding) {
+		return !binding.expression.isActive() || std::ranges::find(s_sourceOptions, binding.expression.source) == s_sourceOptions.end();
+		});
+
+	for (std::uint16_t i = 0; i < m_bindings.size(); i++)
+	{
+		auto& binding = m_bindings[i];
+		const auto& expression = binding.expression;
+
+		// s_sourceOptions lists "None" first
+		const auto name = std::ranges::find(s_sourceOptions, expression.source);
+		const auto type = static_cast<SourceType>(name - s_sourceOptions.begin() - 1);
+
+		RE::TESGlobal* global = nullptr;
+		if (type == SourceType::Global)
+		{
+			global = RE::TESForm::LookupByEditorID<RE::TESGlobal>(expression.global);
+			if (!global)
+			{
+				SKSE::log::warn("Couldn't find global {} bound to {}", expression.global, binding.uniform);
+			}
+		}
+
+		binding.sourceSlot = findSlot(type, global);
+		binding.codeBegin = static_cast<std::uint32_t>(m_program.size());
+
+		m_program.push_back({ Op::Load, binding.sourceSlot });
+		if (expression.scale != 1.f)
+			m_program.push_back({ Op::Mul, 0, expression.scale });
+		if (expression.offset != 0.f)
+			m_program.push_back({ Op::Add, 0, expression.offset });
+		if (expression.min <= expression.max)
+			m_program.push_back({ Op::Clamp, 0, expression.min, expression.max });
+		m_program.push_back({ Op::Store, i });
+
+		binding.codeEnd = static_cast<std::uint32_t>(m_program.size());
+	}
+
+	m_sources = std::move(sources);
+	m_results.assign(m_bindings.size(), 0.f);
+	m_count.store(m_bindings.size(), std::memory_order_relaxed);
+}
+
+void UniformBindings::update()
+{
+	if (size() == 0)
+		return;
+
+	PROFILE_ZONE(Profiler::Zone::EvaluateBindings);
+
+	const auto queue = CommandQueue::GetSingleton();
+
+	std::scoped_lock lock(m_lock);
+
+	for (auto& source : m_sources)
+	{
+		const float value = readSource(source);
+		if (value != source.value)
+		{
+			source.value = value;
+			source.generation++;
+		}
+	}
+
+	for (auto& binding : m_bindings)
+	{
+		const auto& source = m_sources[binding.sourceSlot];
+		if (binding.written && binding.seenGeneration == source.generation)
+			continue;
+
+		float acc = 0.f;
+		for (std::uint32_t pc = binding.codeBegin; pc < binding.codeEnd; pc++)
+		{
+			const auto& instruction = m_program[pc];
+			switch (instruction.op)
+			{
+			case Op::Load: acc = m_sources[instruction.slot].value; break;
+			case Op::Mul: acc *= instruction.a; break;
+			case Op::Add: acc += instruction.a; break;
+			case Op::Clamp: acc = std::clamp(acc, instruction.a, instruction.b); break;
+			case Op::Store: m_results[instruction.slot] = acc; break;
+			}
+		}
+
+		const std::uint32_t index = static_cast<std::uint32_t>(&binding - m_bindings.data());
+		queue->pushSetUniform<float>(binding.effect, binding.uniform.c_str(), &m_results[index], 1, binding.source, binding.ruleID);
+		binding.seenGeneration = source.generation;
+		binding.written = true;
+	}
+}
@@ -0,0 +1,169 @@
+#include "UniformTransitions.h"
+#include "CommandQueue.h"
+#include "Profiler.h"
+
+#include <emmintrin.h>
+
+void UniformTransitions::setUniform(EffectTable::ID effect, const std::string& uniform, const float* values, size_t count, Journal::Source source, std::uint64_t ruleID)
+{
+	count = std::min(count, s_lanes);
+	const auto queue = CommandQueue::GetSingleton();
+	const std::string key = makeKey(effect, uniform);
+
+	std::array<float, s_lanes> target{};
+	std::copy_n(values, count, target.begin());
+
+	std::scoped_lock lock(m_lock);
+
+	const auto flight = std::ranges::find(m_transitions, key, &Transition::key);
+	const size_t index = flight - m_transitions.begin();
+
+	if (flight != m_transitions.end())
+	{
+		// rules reapply their values every tick, keep fading towards the same target
+		if (std::equal(target.begin(), target.end(), m_to.begin() + index * s_lanes))
+			return;
+	}
+
+	const auto known = m_known.find(key);
+	const bool unchanged = known != m_known.end() && known->second == target;
+	const float duration = getDuration();
+
+	if (known == m_known.end() || unchanged || duration <= 0.f)
+	{
+		if (flight != m_transitions.end())
+		{
+			removeTransition(index);
+		}
+		queue->pushSetUniform<float>(effect, uniform.c_str(), target.data(), count, source, ruleID);
+		m_known[key] = target;
+		return;
+	}
+
+	// start from wherever the uniform is right now, mid fade included
+	const float* from = flight != m_transitions.end() ? &m_values[index * s_lanes] : known->second.data();
+
+	Transition transition{ key, effect, uniform, source, ruleID, static_cast<std::uint8_t>(count),
+		source == Journal::Source::Weather && isFollowingWeather(), std::chrono::steady_clock::now(), duration };
+
+	if (flight != m_transitions.end())
+	{
+		std::copy_n(from, s_lanes, m_from.begin() + index * s_lanes);
+		std::copy_n(target.begin(), s_lanes, m_to.begin() + index * s_lanes);
+		m_progress[index] = 0.f;
+		*flight = std::move(transition);
+	}
+	else
+	{
+		m_from.insert(m_from.end(), from, from + s_lanes);
+		m_to.insert(m_to.end(), target.begin(), target.end());
+		m_values.insert(m_values.end(), from, from + s_lanes);
+		m_progress.push_back(0.f);
+		m_transitions.push_back(std::move(transition));
+		m_count.store(m_transitions.size(), std::memory_order_relaxed);
+	}
+
+	m_known[key] = target;
+}
+
+void UniformTransitions::cancel(EffectTable::ID effect, const std::string& uniform)
+{
+	std::scoped_lock lock(m_lock);
+
+	const std::string key = makeKey(effect, uniform);
+	m_known.erase(key);
+
+	if (const auto it = std::ranges::find(m_transitions, key, &Transition::key); it != m_transitions.end())
+	{
+		removeTransition(it - m_transitions.begin());
+	}
+}
+
+void UniformTransitions::clear()
+{
+	std::scoped_lock lock(m_lock);
+
+	m_transitions.clear();
+	m_progress.clear();
+	m_from.clear();
+	m_to.clear();
+	m_values.clear();
+	m_known.clear();
+	m_count.store(0, std::memory_order_relaxed);
+}
+
+void UniformTransitions::removeTransition(size_t index)
+{
+	const size_t last = m_transitions.size() - 1;
+	if (index != last)
+	{
+		m_transitions[index] = std::move(m_transitions[last]);
+		m_progress[index] = m_progress[last];
+		std::copy_n(m_from.begin() + last * s_lanes, s_lanes, m_from.begin() + index * s_lanes);
+		std::copy_n(m_to.begin() + last * s_lanes, s_lanes, m_to.begin() + index * s_lanes);
+		std::copy_n(m_values.begin() + last * s_lanes, s_lanes, m_values.begin() + index * s_lanes);
+	}
+
+	m_transitions.pop_back();
+	m_progress.pop_back();
+	m_from.resize(last * s_lanes);
+	m_to.resize(last * s_lanes);
+	m_values.resize(last * s_lanes);
+	m_count.store(m_transitions.size(), std::memory_order_relaxed);
+}
+
+void UniformTransitions::update()
+{
+	if (size() == 0)
+		return;
+
+	PROFILE_ZONE(Profiler::Zone::UpdateTransitions);
+
+	const auto now = std::chrono::steady_clock::now();
+	const auto sky = RE::Sky::GetSingleton();
+	const float weatherPct = sky ? std::clamp(sky->currentWeatherPct, 0.f, 1.f) : 1.f;
+
+	const auto queue = CommandQueue::GetSingleton();
+
+	std::scoped_lock lock(m_lock);
+
+	const size_t count = m_transitions.size();
+	for (size_t i = 0; i < count; i++)
+	{
+		const auto& transition = m_transitions[i];
+		if (transition.followWeather)
+		{
+			m_progress[i] = weatherPct;
+		}
+		else
+		{
+			const float elapsed = std::chrono::duration<float>(now - transition.start).count();
+			m_progress[i] = std::min(elapsed / transition.duration, 1.f);
+		}
+	}
+
+	// values = from + (to - from) * progress, one transition per register
+	const float* from = m_from.data();
+	const float* to = m_to.data();
+	float* values = m_values.data();
+	for (size_t i = 0; i < count; i++)
+	{
+		const __m128 a = _mm_loadu_ps(from + i * s_lanes);
+		const __m128 b = _mm_loadu_ps(to + i * s_lanes);
+		const __m128 t = _mm_set1_ps(m_progress[i]);
+		_mm_storeu_ps(values + i * s_lanes, _mm_add_ps(a, _mm_mul_ps(_mm_sub_ps(b, a), t)));
+	}
+
+	for (size_t i = 0; i < m_transitions.size();)
+	{
+		const auto& transition = m_transitions[i];
+		queue->pushSetUniform<float>(transition.effect, transition.uniform.c_str(), &m_values[i * s_lanes], transition.valueCount, transition.source, transition.ruleID);
+
+		if (m_progress[i] >= 1.f)
+		{
+			removeTransition(i);
+			continue;
+		}
+		i++;
+	}
+}
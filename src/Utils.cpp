@@ -52,6 +52,21 @@ namespace Utils
 		}
 	}
 
+	void loadINIBoolSetting(const CSimpleIniA& a_ini, const char* a_sectionName, const char* a_settingName, bool& a_setting)
+	{
+		a_setting = a_ini.GetBoolValue(a_sectionName, a_settingName, a_setting);
+	}
+
+	void loadINIIntSetting(const CSimpleIniA& a_ini, const char* a_sectionName, const char* a_settingName, int& a_setting)
+	{
+		a_setting = static_cast<int>(a_ini.GetLongValue(a_sectionName, a_settingName, a_setting));
+	}
+
+	void loadINIFloatSetting(const CSimpleIniA& a_ini, const char* a_sectionName, const char* a_settingName, float& a_setting)
+	{
+		a_setting = static_cast<float>(a_ini.GetDoubleValue(a_sectionName, a_settingName, a_setting));
+	}
+
 	std::string tolower(std::string_view a_str)
 	{
 		std::string result(a_str);
@@ -2,15 +2,51 @@
 #include "Events.h"
 #include "Manager.h"
 #include "Menu.h"
+#include "Profiler.h"
+#include "FrameGovernor.h"
+#include "EffectPrewarmer.h"
+#include "Logging.h"
 #include <Papyrus.h>
 
-reshade::api::effect_runtime* s_pRuntime = nullptr;
 HMODULE g_hModule = nullptr;
 
-// Callback when Reshade begins effects
-static void on_reshade_begin_effects(reshade::api::effect_runtime* runtime)
+static void on_init_effect_runtime(reshade::api::effect_runtime* runtime)
 {
-	s_pRuntime = runtime;
+	RuntimeRegistry::GetSingleton()->add(runtime);
+	Manager::GetSingleton()->rebuildEffectIndex();
+}
+
+static void on_destroy_effect_runtime(reshade::api::effect_runtime* runtime)
+{
+	RuntimeRegistry::GetSingleton()->remove(runtime);
+	Manager::GetSingleton()->rebuildEffectIndex();
+}
+
+static void on_reshade_reloaded_effects(reshade::api::effect_runtime* runtime)
+{
+	RuntimeRegistry::GetSingleton()->invalidate(runtime);
+	Manager::GetSingleton()->rebuildEffectIndex();
+	EffectPrewarmer::GetSingleton()->reset();
+
+	// reloading resets the techniques to the ReShade preset, the passes have to apply their toggles again
+	Manager::GetSingleton()->invalidateFingerprints();
+	TickScheduler::GetSingleton()->wakeAll();
+}
+
+static void on_reshade_present(reshade::api::effect_runtime* runtime)
+{
+	// with VR both eyes present, the frame time is taken from one of them
+	if (runtime == RuntimeRegistry::GetSingleton()->getPrimary())
+	{
+		FrameGovernor::GetSingleton()->onPresent();
+	}
+
+	// present fires even while effects are disabled, so a queued "enable ReShade" still gets applied
+	Manager::GetSingleton()->executeCommands();
+
+#ifdef ENABLE_PROFILER
+	Profiler::GetSingleton()->collect();
+#endif
 }
 
 static void DrawMenu(reshade::api::effect_runtime*)
@@ -21,13 +57,19 @@ static void DrawMenu(reshade::api::effect_runtime*)
 // Register and unregister addon events
 void register_addon_events()
 {
-	reshade::register_event<reshade::addon_event::init_effect_runtime>(on_reshade_begin_effects);
+	reshade::register_event<reshade::addon_event::init_effect_runtime>(on_init_effect_runtime);
+	reshade::register_event<reshade::addon_event::destroy_effect_runtime>(on_destroy_effect_runtime);
+	reshade::register_event<reshade::addon_event::reshade_present>(on_reshade_present);
+	reshade::register_event<reshade::addon_event::reshade_reloaded_effects>(on_reshade_reloaded_effects);
 	reshade::register_overlay(nullptr, &DrawMenu);
 }
 
 void unregister_addon_events()
 {
-	reshade::unregister_event<reshade::addon_event::init_effect_runtime>(on_reshade_begin_effects);
+	reshade::unregister_event<reshade::addon_event::init_effect_runtime>(on_init_effect_runtime);
+	reshade::unregister_event<reshade::addon_event::destroy_effect_runtime>(on_destroy_effect_runtime);
+	reshade::unregister_event<reshade::addon_event::reshade_present>(on_reshade_present);
+	reshade::unregister_event<reshade::addon_event::reshade_reloaded_effects>(on_reshade_reloaded_effects);
 	reshade::unregister_overlay(nullptr, &DrawMenu);
 }
 
@@ -62,6 +104,10 @@ void MessageListener(SKSE::MessagingInterface::Message* message)
 		Hook::Install();
 		const auto manager = Manager::GetSingleton();
 		manager->parseINI();
+		if (manager->isJournalEnabled())
+		{
+			Journal::GetSingleton()->start();
+		}
 		if (!manager->parseJSONPreset(manager->getLastPreset()))
 		{
 			manager->setLastPreset("");
@@ -117,17 +163,8 @@ int __stdcall DllMain(HMODULE hModule, uint32_t fdwReason, void*)
 
 SKSEPluginLoad(const SKSE::LoadInterface* skse)
 {
-	SKSE::Init(skse, true);
-
-	spdlog::set_pattern("[%H:%M:%S:%e] [%l] %v"s);
-
-#ifndef NDEBUG
-	spdlog::set_level(spdlog::level::trace);
-	spdlog::flush_on(spdlog::level::trace);
-#else
-	spdlog::set_level(spdlog::level::info);
-	spdlog::flush_on(spdlog::level::info);
-#endif
+	SKSE::Init(skse, false);
+	Logging::Init();
 
 	SKSE::log::info("Game version: {}", skse->RuntimeVersion());
 
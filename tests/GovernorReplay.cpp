@@ -0,0 +1,231 @@
+#include "GovernorPolicy.h"
+
+#include <cstdio>
+#include <random>
+
+// Replays synthetic frame time traces against GovernorPolicy. The trace is closed loop: every frame costs
+// a base time plus the cost of each effect that is still enabled plus some noise, so a shed shows up in
+// the following frames the same way it would in game.
+
+namespace
+{
+	int s_failures = 0;
+
+#define CHECK(condition)                                                     \
+	do {                                                                     \
+		if (!(condition)) {                                                  \
+			std::printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #condition); \
+			s_failures++;                                                    \
+		}                                                                    \
+	} while (false)
+
+	using Policy = GovernorPolicy;
+
+	struct Effect
+	{
+		Policy::EffectID id;
+		int priority;
+		float costMs;
+		bool enabled = true;
+	};
+
+	struct Trace
+	{
+		Policy policy;
+		std::vector<Effect> effects;
+		std::mt19937 rng{ 1337 };
+		float baseMs = 0.f;
+		float noiseMs = 0.5f;
+		int sheds = 0;
+		int restores = 0;
+
+		Trace(float targetMs, std::vector<Effect> list) : effects(std::move(list))
+		{
+			Policy::Config config;
+			config.enabled = true;
+			config.targetMs = targetMs;
+
+			std::vector<Policy::Candidate> candidates;
+			for (const auto& effect : effects)
+			{
+				Policy::Candidate candidate;
+				candidate.effect = effect.id;
+				candidate.priority = effect.priority;
+				candidates.push_back(candidate);
+			}
+			policy.configure(config, std::move(candidates));
+		}
+
+		Effect& get(Policy::EffectID id)
+		{
+			return *std::find_if(effects.begin(), effects.end(), [id](const Effect& effect) { return effect.id == id; });
+		}
+
+		void frame(float frameMs)
+		{
+			const auto decision = policy.onFrame(frameMs, [this](Policy::EffectID id) { return get(id).enabled; });
+			if (decision.action == Policy::Action::Shed)
+				sheds++;
+			else if (decision.action == Policy::Action::Restore)
+				restores++;
+
+			if (decision.action != Policy::Action::None)
+			{
+				get(decision.effect).enabled = decision.state;
+			}
+		}
+
+		void run(int frames)
+		{
+			std::uniform_real_distribution<float> noise(-noiseMs, noiseMs);
+			for (int i = 0; i < frames; i++)
+			{
+				float frameMs = baseMs + noise(rng);
+				for (const auto& effect : effects)
+				{
+					if (effect.enabled)
+						frameMs += effect.costMs;
+				}
+				frame(frameMs);
+			}
+		}
+
+		const Policy::Candidate& candidate(Policy::EffectID id) const
+		{
+			const auto& candidates = policy.getCandidates();
+			return *std::find_if(candidates.begin(), candidates.end(), [id](const Policy::Candidate& candidate) { return candidate.effect == id; });
+		}
+	};
+
+	// 21 ms against a 16.7 ms target: the two lowest priorities go, the third stays
+	void shedsInPriorityOrderUntilUnderBudget()
+	{
+		Trace trace(16.7f, { { 1, 0, 3.f }, { 2, 1, 4.f }, { 3, 2, 2.f } });
+		trace.baseMs = 12.f;
+		trace.run(5000);
+
+		CHECK(!trace.get(1).enabled);
+		CHECK(!trace.get(2).enabled);
+		CHECK(trace.get(3).enabled);
+		CHECK(trace.sheds == 2);
+		CHECK(trace.restores == 0);
+		CHECK(trace.policy.isShed(1) && trace.policy.isShed(2) && !trace.policy.isShed(3));
+		CHECK(trace.policy.getPercentileMs() <= 16.7f);
+
+		// the saving of each shed is measured from the percentile before and after
+		CHECK(std::abs(trace.candidate(1).measuredCostMs - 3.f) < 0.5f);
+		CHECK(std::abs(trace.candidate(2).measuredCostMs - 4.f) < 0.5f);
+	}
+
+	// once the load drops the last shed effect comes back, the first only if it fits under the restore ratio
+	void restoresLastInFirstOutWithHysteresis()
+	{
+		Trace trace(16.7f, { { 1, 0, 3.f }, { 2, 1, 4.f }, { 3, 2, 2.f } });
+		trace.baseMs = 12.f;
+		trace.run(5000);
+
+		trace.baseMs = 7.f;
+		trace.run(5000);
+
+		CHECK(!trace.get(1).enabled); // 9.5 + 4 + 3 is over 16.7 * 0.85
+		CHECK(trace.get(2).enabled);
+		CHECK(trace.get(3).enabled);
+		CHECK(trace.sheds == 2);
+		CHECK(trace.restores == 1);
+
+		trace.baseMs = 4.f;
+		trace.run(5000);
+
+		CHECK(trace.get(1).enabled);
+		CHECK(trace.restores == 2);
+		CHECK(!trace.policy.isShed(1));
+	}
+
+	// hovering right at the target with noise must not flip an effect back and forth
+	void noisyLoadDoesNotOscillate()
+	{
+		Trace trace(16.7f, { { 1, 0, 2.f }, { 2, 1, 2.f } });
+		trace.baseMs = 12.5f;
+		trace.noiseMs = 2.f;
+		trace.run(20000);
+
+		CHECK(trace.sheds <= 1);
+		CHECK(trace.restores == 0);
+	}
+
+	// loading screens and single hitches are not frame times of the preset
+	void hitchesAreIgnored()
+	{
+		Trace trace(16.7f, { { 1, 0, 2.f } });
+		trace.baseMs = 10.f;
+
+		for (int i = 0; i < 5000; i++)
+		{
+			trace.frame(i % 50 == 0 ? 400.f : 12.f);
+		}
+
+		CHECK(trace.sheds == 0);
+		CHECK(trace.get(1).enabled);
+	}
+
+	// effects that don't render are skipped, there is nothing to gain from them
+	void disabledEffectsAreNotShed()
+	{
+		Trace trace(16.7f, { { 1, 0, 3.f }, { 2, 1, 8.f } });
+		trace.get(1).enabled = false;
+		trace.baseMs = 12.f;
+		trace.run(5000);
+
+		CHECK(trace.get(2).enabled == false);
+		CHECK(!trace.policy.isShed(1));
+		CHECK(trace.sheds == 1);
+	}
+
+	// another source switching a shed effect off makes it return to off, without waiting for the budget
+	void observedTogglesDecideTheRestoredState()
+	{
+		Trace trace(16.7f, { { 1, 0, 6.f } });
+		trace.baseMs = 12.f;
+		trace.run(2000);
+		CHECK(trace.policy.isShed(1));
+
+		trace.policy.observe(1, false);
+		trace.run(2000);
+
+		CHECK(!trace.policy.isShed(1));
+		CHECK(trace.restores == 1);
+		CHECK(!trace.get(1).enabled);
+	}
+
+	// a new configuration hands back whatever was shed so the caller can restore it
+	void configureReturnsShedEffects()
+	{
+		Trace trace(16.7f, { { 1, 0, 6.f } });
+		trace.baseMs = 12.f;
+		trace.run(2000);
+
+		const auto restore = trace.policy.configure(trace.policy.getConfig(), {});
+		CHECK(restore.size() == 1 && restore.front().effect == 1 && restore.front().wanted);
+		CHECK(!trace.policy.isShed(1));
+	}
+}
+
+int main()
+{
+	shedsInPriorityOrderUntilUnderBudget();
+	restoresLastInFirstOutWithHysteresis();
+	noisyLoadDoesNotOscillate();
+	hitchesAreIgnored();
+	disabledEffectsAreNotShed();
+	observedTogglesDecideTheRestoredState();
+	configureReturnsShedEffects();
+
+	if (s_failures)
+	{
+		std::printf("%d checks failed\n", s_failures);
+		return 1;
+	}
+
+	std::printf("all traces passed\n");
+	return 0;
+}